@@ -0,0 +1,115 @@
+/*
+ * Region allocation for per-master parse structures.
+ *
+ * Blocks start small and double up to a limit, so the many masters
+ * with a handful of revisions don't each pin down a big block for the
+ * whole run.
+ *
+ * Carving objects out of blocks hides them from memory checkers.  An
+ * earlier slab attempt in nodehash.c broke in ways that only showed
+ * up under valgrind on a big conversion.  So:
+ *
+ *  - Under AddressSanitizer, the unused parts of each block and the
+ *    padding after each object stay poisoned.
+ *  - Under valgrind, the same regions are marked inaccessible.
+ *  - Built with -DARENA_DEBUG, every object gets its own malloc and is
+ *    overwritten with a poison pattern before it is freed.  The
+ *    checkers then see each object's lifetime exactly, and a stale
+ *    pointer reads junk instead of plausible data.
+ *
+ *  SPDX-License-Identifier: GPL-2.0+
+ */
+
+#include <string.h>
+
+#include "cvs.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/asan_interface.h>
+#define POISON(p, n)	ASAN_POISON_MEMORY_REGION(p, n)
+#define UNPOISON(p, n)	ASAN_UNPOISON_MEMORY_REGION(p, n)
+#elif defined(__has_include)
+#if __has_include(<valgrind/memcheck.h>)
+#include <valgrind/memcheck.h>
+#define POISON(p, n)	VALGRIND_MAKE_MEM_NOACCESS(p, n)
+#define UNPOISON(p, n)	VALGRIND_MAKE_MEM_UNDEFINED(p, n)
+#endif
+#endif
+#ifndef POISON
+#define POISON(p, n)	((void)(p), (void)(n))
+#define UNPOISON(p, n)	((void)(p), (void)(n))
+#endif
+
+#define ARENA_ALIGN		16
+#define ARENA_FIRST_BLOCK	128
+#define ARENA_MAX_BLOCK		(64 * 1024)
+#define ARENA_POISON		0x6b
+
+#define ROUNDUP(n)	(((n) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+typedef struct _arena_block {
+    struct _arena_block	*next;
+    size_t		size;	/* bytes of data; one object's with ARENA_DEBUG */
+} arena_block_t;
+
+#define BLOCK_DATA(b)	((char *)(b) + ROUNDUP(sizeof(arena_block_t)))
+
+void *
+arena_alloc(arena_t *arena, size_t size, const char *legend)
+/* allocate zeroed storage that lives until the arena is freed */
+{
+    arena_block_t *b;
+    void *p;
+
+#ifdef ARENA_DEBUG
+    b = xmalloc(ROUNDUP(sizeof(arena_block_t)) + size, legend);
+    b->size = size;
+    b->next = arena->blocks;
+    arena->blocks = b;
+    p = BLOCK_DATA(b);
+#else
+    size_t need = ROUNDUP(size ? size : 1);
+
+    if (need > arena->left) {
+	size_t want = arena->blocks ? 2 * arena->blocks->size : ARENA_FIRST_BLOCK;
+
+	if (want > ARENA_MAX_BLOCK)
+	    want = ARENA_MAX_BLOCK;
+	if (want < need)
+	    want = need;
+	b = xmalloc(ROUNDUP(sizeof(arena_block_t)) + want, legend);
+	b->size = want;
+	b->next = arena->blocks;
+	arena->blocks = b;
+	arena->next = BLOCK_DATA(b);
+	arena->left = want;
+	POISON(arena->next, arena->left);
+    }
+    p = arena->next;
+    arena->next += need;
+    arena->left -= need;
+    UNPOISON(p, size);	/* the alignment padding stays poisoned */
+#endif /* ARENA_DEBUG */
+    return memset(p, '\0', size);
+}
+
+void
+arena_free(arena_t *arena)
+/* release everything allocated from the arena, leaving it empty */
+{
+    arena_block_t *b, *next;
+
+    for (b = arena->blocks; b != NULL; b = next) {
+	next = b->next;
+	UNPOISON(BLOCK_DATA(b), b->size);
+#ifdef ARENA_DEBUG
+	memset(BLOCK_DATA(b), ARENA_POISON, b->size);
+#endif /* ARENA_DEBUG */
+	free(b);
+    }
+    arena->blocks = NULL;
+    arena->next = NULL;
+    arena->left = 0;
+}
+
+/* end */
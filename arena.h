@@ -0,0 +1,25 @@
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stddef.h>
+
+/*
+ * A region allocator for structures that all die together, such as
+ * everything parsed out of one CVS master.  Objects can't be freed
+ * one at a time; arena_free() releases the lot.
+ */
+typedef struct _arena {
+    struct _arena_block	*blocks;	/* newest first */
+    char		*next;		/* free space in the newest block */
+    size_t		left;
+} arena_t;
+
+/* allocate zeroed storage that lives until the arena is freed */
+void *
+arena_alloc(arena_t *arena, size_t size, const char *legend);
+
+/* release everything allocated from the arena, leaving it empty */
+void
+arena_free(arena_t *arena);
+
+#endif /* _ARENA_H_ */
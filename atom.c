@@ -10,138 +10,274 @@
 #ifdef THREADS
 #include <pthread.h>
 #endif /* THREADS */
-/*****************************************************************************
-
-From http://planetmath.org/goodhashtableprimes:
-
-In the course of designing a good hashing configuration, it is helpful
-to have a list of prime numbers for the hash table size.
-
-The following is such a list. It has the properties that:
-
-    1. each number in the list is prime
-    2. each number is slightly less than twice the size of the previous
-    3. each number is as far as possible from the nearest two powers of two
-
-Using primes for hash tables is a good idea because it minimizes
-clustering in the hashed table. Item (2) is nice because it is
-convenient for growing a hash table in the face of expanding
-data. Item (3) has, allegedly, been shown to yield especially good
-results in practice.
-
-And here is the list:
-
-lwr 	upr 	% err   	prime
-2^5 	2^6 	10.416667 	53
-2^6 	2^7 	1.041667 	97
-2^7 	2^8 	0.520833 	193
-2^8 	2^9 	1.302083 	389
-2^9 	2^10 	0.130208 	769
-2^10 	2^11 	0.455729 	1543
-2^11 	2^12 	0.227865 	3079
-2^12 	2^13 	0.113932 	6151
-2^13 	2^14 	0.008138 	12289
-2^14 	2^15 	0.069173 	24593
-2^15 	2^16 	0.010173 	49157
-2^16 	2^17 	0.013224 	98317
-2^17 	2^18 	0.002543 	196613
-2^18 	2^19 	0.006358 	393241
-2^19 	2^20 	0.000127 	786433
-2^20 	2^21 	0.000318 	1572869
-2^21 	2^22 	0.000350 	3145739
-2^22 	2^23 	0.000207 	6291469
-2^23 	2^24 	0.000040 	12582917
-2^24 	2^25 	0.000075 	25165843
-2^25 	2^26 	0.000010 	50331653
-2^26 	2^27 	0.000023 	100663319
-2^27 	2^28 	0.000009 	201326611
-2^28 	2^29 	0.000001 	402653189
-2^29 	2^30 	0.000011 	805306457
-2^30 	2^31 	0.000000 	1610612741
-
-The columns are, in order, the lower bounding power of two, the upper
-bounding power of two, the relative deviation (in percent) of the
-prime number from the optimal middle of the first two, and finally the
-prime itself.
-
-Happy hashing!
-
-*****************************************************************************/
 
 /*
- * This prime number is scaled to be effective for the NetBSD src
- * repository, which at around 135K masters is the largest we know of.
- * The intent is to reduce expected depth of the hash buckets in the
- * worst case to about 4.  Space cost on a 64-bit machine is 8 times
- * this in bytes.
+ * The intern tables are all split into shards on the top bits of the
+ * hash.  Each shard is an open-addressed table with linear probing
+ * that doubles when it gets three-quarters full, so it grows with
+ * the repository instead of being tuned for one.
+ *
+ * Lookups take no lock.  A slot is published with a release store
+ * only once the entry it points at is complete, and a grown table is
+ * published the same way once it has been filled, so a reader that
+ * sees a pointer sees everything behind it.  A table replaced by
+ * growth is kept until discard_atoms() because a reader may still be
+ * probing it; a miss there just sends the reader down the locked
+ * path, which looks again in the current table.  Inserts lock only
+ * their own shard.
  */
-#define HASH_SIZE	49157
+#define SHARD_BITS	6
+#define NSHARDS		(1 << SHARD_BITS)
+#define INITIAL_SLOTS	256
 
 unsigned int natoms;	/* we report this so we can tune the hash properly */
 
-typedef struct _hash_bucket {
-    struct _hash_bucket	*next;
-    hash_t		hash;
-    char		string[0];
-} hash_bucket_t;
+typedef struct _intern_entry {
+    hash_t		hash;	/* every kind of entry starts with its hash */
+} intern_entry_t;
 
-static hash_bucket_t	*buckets[HASH_SIZE];
+typedef struct _intern_slots {
+    struct _intern_slots *retired;	/* the table this one replaced */
+    size_t		mask;
+    intern_entry_t	*slot[];
+} intern_slots_t;
+
+typedef struct _intern_shard {
+    intern_slots_t	*slots;
+    size_t		count;
 #ifdef THREADS
-static pthread_mutex_t bucket_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_mutex_t	mutex;
 #endif /* THREADS */
+} intern_shard_t;
 
-const char *
-atom(const char *string)
-/* intern a string, avoiding having separate storage for duplicate copies */
+typedef struct _intern_table {
+    intern_shard_t	shard[NSHARDS];
+    bool		(*match)(const intern_entry_t *, const void *key);
+    intern_entry_t	*(*make)(const void *key, hash_t hash);
+} intern_table_t;
+
+static bool string_match(const intern_entry_t *, const void *);
+static intern_entry_t *string_make(const void *, hash_t);
+static bool number_match(const intern_entry_t *, const void *);
+static intern_entry_t *number_make(const void *, hash_t);
+static bool blob_match(const intern_entry_t *, const void *);
+static intern_entry_t *blob_make(const void *, hash_t);
+
+static intern_table_t	string_table = {.match = string_match, .make = string_make};
+static intern_table_t	number_table = {.match = number_match, .make = number_make};
+static intern_table_t	blob_table = {.match = blob_match, .make = blob_make};
+
+#ifdef THREADS
+static pthread_once_t	intern_once = PTHREAD_ONCE_INIT;
+
+static void
+intern_init(void)
+/* set up the shard locks */
 {
-    hash_t		hash = hash_string(string);
-    hash_bucket_t	**head = &buckets[hash % HASH_SIZE];
-    hash_bucket_t	*b;
-    int			len;
+    int i;
 
-    while ((b = *head)) {
-collision:
-	if (b->hash == hash && !strcmp(string, b->string))
-	    return b->string;
-	head = &(b->next);
+    for (i = 0; i < NSHARDS; i++) {
+	pthread_mutex_init(&string_table.shard[i].mutex, NULL);
+	pthread_mutex_init(&number_table.shard[i].mutex, NULL);
+	pthread_mutex_init(&blob_table.shard[i].mutex, NULL);
     }
-#ifdef THREADS
-    if (threads > 1)
-	pthread_mutex_lock(&bucket_mutex);
+}
 #endif /* THREADS */
-    if ((b = *head)) {
+
+static inline hash_t
+intern_spread(hash_t hash)
+/* FNV leaves the top bits weak; mix before picking shard and slot */
+{
+    hash *= 0x9e3779b1;
+    return hash ^ (hash >> 15);
+}
+
+static intern_entry_t *
+intern_find(const intern_table_t *table, const intern_slots_t *t,
+	    hash_t hash, const void *key)
+/* probe one table for a key, NULL if it isn't there */
+{
+    intern_entry_t *e;
+    size_t i;
+
+    if (t == NULL)
+	return NULL;
+    for (i = intern_spread(hash) & t->mask;; i = (i + 1) & t->mask) {
+	e = __atomic_load_n(&t->slot[i], __ATOMIC_ACQUIRE);
+	if (e == NULL || (e->hash == hash && table->match(e, key)))
+	    return e;
+    }
+}
+
+static void
+intern_place(intern_slots_t *t, intern_entry_t *e)
+/* put an entry in the first free slot of its probe sequence */
+{
+    size_t i = intern_spread(e->hash) & t->mask;
+
+    while (t->slot[i] != NULL)
+	i = (i + 1) & t->mask;
+    __atomic_store_n(&t->slot[i], e, __ATOMIC_RELEASE);
+}
+
+static void
+intern_grow(intern_shard_t *shard)
+/* double a shard's table; caller holds its lock */
+{
+    intern_slots_t *old = shard->slots, *t;
+    size_t size = old ? 2 * (old->mask + 1) : INITIAL_SLOTS, i;
+
+    t = xcalloc(1, sizeof(intern_slots_t) + size * sizeof(intern_entry_t *),
+		"intern table");
+    t->mask = size - 1;
+    t->retired = old;
+    if (old)
+	for (i = 0; i <= old->mask; i++)
+	    if (old->slot[i])
+		intern_place(t, old->slot[i]);
+    __atomic_store_n(&shard->slots, t, __ATOMIC_RELEASE);
+}
+
+static const intern_entry_t *
+intern(intern_table_t *table, hash_t hash, const void *key)
+/* find or add the entry for a key */
+{
+    intern_shard_t *shard = &table->shard[intern_spread(hash) >> (32 - SHARD_BITS)];
+    intern_entry_t *e;
+
+    e = intern_find(table, __atomic_load_n(&shard->slots, __ATOMIC_ACQUIRE),
+		    hash, key);
+    if (e != NULL)
+	return e;
 #ifdef THREADS
-	if (threads > 1)
-	    pthread_mutex_unlock(&bucket_mutex);
+    if (threads > 1) {
+	pthread_once(&intern_once, intern_init);
+	pthread_mutex_lock(&shard->mutex);
+	/* someone may have added it, or grown the table, since we looked */
+	e = intern_find(table, shard->slots, hash, key);
+    }
 #endif /* THREADS */
-	goto collision;
+    if (e == NULL) {
+	if (shard->slots == NULL || (shard->count + 1) * 4 > (shard->slots->mask + 1) * 3)
+	    intern_grow(shard);
+	e = table->make(key, hash);
+	intern_place(shard->slots, e);
+	shard->count++;
     }
-
-    len = strlen(string);
-    b = xmalloc(sizeof(hash_bucket_t) + len + 1, __func__);
-    b->next = 0;
-    b->hash = hash;
-    memcpy(b->string, string, len + 1);
-    *head = b;
-    natoms++;
 #ifdef THREADS
     if (threads > 1)
-	pthread_mutex_unlock(&bucket_mutex);
+	pthread_mutex_unlock(&shard->mutex);
 #endif /* THREADS */
-    return b->string;
+    return e;
+}
+
+static void
+intern_stats(const intern_table_t *table, const char *what, FILE *fp)
+/* report the load factor and probe lengths of an intern table */
+{
+    size_t count = 0, slots = 0, probes = 0, longest = 0, i;
+    int s;
+
+    for (s = 0; s < NSHARDS; s++) {
+	const intern_slots_t *t = table->shard[s].slots;
+
+	if (t == NULL)
+	    continue;
+	slots += t->mask + 1;
+	for (i = 0; i <= t->mask; i++) {
+	    size_t probe;
+
+	    if (t->slot[i] == NULL)
+		continue;
+	    probe = ((i - intern_spread(t->slot[i]->hash)) & t->mask) + 1;
+	    probes += probe;
+	    if (probe > longest)
+		longest = probe;
+	    count++;
+	}
+    }
+    fprintf(fp, "%zu %s in %zu slots, load %.2f, mean probe %.2f, longest %zu.\n",
+	    count, what, slots, slots ? (double)count / slots : 0.0,
+	    count ? (double)probes / count : 0.0, longest);
+}
+
+static void
+intern_free(intern_table_t *table)
+/* free every entry and table, including ones retired by growth */
+{
+    int s;
+
+    for (s = 0; s < NSHARDS; s++) {
+	intern_shard_t *shard = &table->shard[s];
+	intern_slots_t *t = shard->slots, *next;
+	size_t i;
+
+	if (t != NULL)
+	    for (i = 0; i <= t->mask; i++)
+		free(t->slot[i]);
+	for (; t != NULL; t = next) {
+	    next = t->retired;
+	    free(t);
+	}
+	shard->slots = NULL;
+	shard->count = 0;
+    }
+}
+
+typedef struct _hash_bucket {
+    intern_entry_t	entry;
+    char		string[0];
+} hash_bucket_t;
+
+static bool
+string_match(const intern_entry_t *e, const void *key)
+{
+    return !strcmp(((const hash_bucket_t *)e)->string, key);
+}
+
+static intern_entry_t *
+string_make(const void *key, hash_t hash)
+{
+    size_t len = strlen(key);
+    hash_bucket_t *b = xmalloc(sizeof(hash_bucket_t) + len + 1, "atom");
+
+    b->entry.hash = hash;
+    memcpy(b->string, key, len + 1);
+    __atomic_fetch_add(&natoms, 1, __ATOMIC_RELAXED);
+    return &b->entry;
+}
+
+const char *
+atom(const char *string)
+/* intern a string, avoiding having separate storage for duplicate copies */
+{
+    const intern_entry_t *e = intern(&string_table, hash_string(string), string);
+
+    return ((const hash_bucket_t *)e)->string;
 }
 
 typedef struct _number_bucket {
-    struct _number_bucket *next;
-    cvs_number number;
+    intern_entry_t	entry;
+    cvs_number		number;	/* truncated to number.c components */
 } number_bucket_t;
 
-#define NUMBER_HASH_SIZE 6151
+static bool
+number_match(const intern_entry_t *e, const void *key)
+{
+    return cvs_number_equal(&((const number_bucket_t *)e)->number, key);
+}
 
-static number_bucket_t  *number_buckets[NUMBER_HASH_SIZE];
-#ifdef THREADS
-static pthread_mutex_t number_bucket_mutex = PTHREAD_MUTEX_INITIALIZER;
-#endif /* THREADS */
+static intern_entry_t *
+number_make(const void *key, hash_t hash)
+{
+    const cvs_number *n = key;
+    number_bucket_t *b = xmalloc(offsetof(number_bucket_t, number)
+				 + CVS_NUMBER_SIZE(n->c), "atom_cvs_number");
+
+    b->entry.hash = hash;
+    cvs_number_copy(&b->number, n);
+    return &b->entry;
+}
 
 /*
  * Intern a revision number
@@ -150,62 +286,89 @@ static pthread_mutex_t number_bucket_mutex = PTHREAD_MUTEX_INITIALIZER;
 const cvs_number *
 atom_cvs_number(const cvs_number n)
 {
-    size_t          bucket = hash_cvs_number(&n) % NUMBER_HASH_SIZE;
-    number_bucket_t **head = &number_buckets[bucket];
-    number_bucket_t *b;
+    const intern_entry_t *e = intern(&number_table, hash_cvs_number(&n), &n);
 
-    while ((b = *head)) {
-    collision:
-	if (cvs_number_equal(&b->number, &n))
-	    return &b->number;
-	head = &(b->next);
-    }
-#ifdef THREADS
-    if (threads > 1)
-	pthread_mutex_lock(&number_bucket_mutex);
-#endif /* THREADS */
-    if ((b = *head)) {
-#ifdef THREADS
-	if (threads > 1)
-	    pthread_mutex_unlock(&number_bucket_mutex);
-#endif /* THREADS */
-	goto collision;
-    }
+    return &((const number_bucket_t *)e)->number;
+}
 
-    b = xmalloc(sizeof(number_bucket_t), __func__);
-    b->next = NULL;
-    memcpy(&b->number, &n, sizeof(cvs_number));
-    *head = b;
-#ifdef THREADS
-    if (threads > 1)
-	pthread_mutex_unlock(&number_bucket_mutex);
-#endif /* THREADS */
-    return &b->number;
+static unsigned int nblobs;	/* distinct snapshot contents seen */
+
+typedef struct _blob_bucket {
+    intern_entry_t	entry;
+    serial_t		serial;
+    uint8_t		id[SHA1_SIZE];
+} blob_bucket_t;
+
+typedef struct _blob_key {
+    const uint8_t	*id;
+    serial_t		serial;
+} blob_key_t;
+
+static bool
+blob_match(const intern_entry_t *e, const void *key)
+{
+    return !memcmp(((const blob_bucket_t *)e)->id,
+		   ((const blob_key_t *)key)->id, SHA1_SIZE);
+}
+
+static intern_entry_t *
+blob_make(const void *key, hash_t hash)
+{
+    const blob_key_t *k = key;
+    blob_bucket_t *b = xmalloc(sizeof(blob_bucket_t), "atom_blob");
+
+    b->entry.hash = hash;
+    b->serial = k->serial;
+    memcpy(b->id, k->id, SHA1_SIZE);
+    __atomic_fetch_add(&nblobs, 1, __ATOMIC_RELAXED);
+    return &b->entry;
+}
+
+serial_t
+atom_blob(const uint8_t id[SHA1_SIZE], serial_t serial)
+/* intern a snapshot's content id, returning the serial that got there first */
+{
+    blob_key_t key = {id, serial};
+    hash_t hash;
+    const intern_entry_t *e;
+
+    /* the id is already as good a hash as there is */
+    memcpy(&hash, id, sizeof(hash));
+    e = intern(&blob_table, hash, &key);
+    return ((const blob_bucket_t *)e)->serial;
 }
+
 void
-discard_atoms(void)
-/* empty all string buckets */
+atom_stats(FILE *fp)
+/* report on the intern tables, for tuning */
 {
-    hash_bucket_t	**head, *b;
-    int			i;
+    intern_stats(&string_table, "atoms", fp);
+    intern_stats(&number_table, "revision numbers", fp);
+    if (nblobs > 0)
+	intern_stats(&blob_table, "blob ids", fp);
+}
 
-#ifdef THREADS
-    if (threads > 1)
-	pthread_mutex_lock(&bucket_mutex);
-#endif /* THREADS */
-    for (i = 0; i < HASH_SIZE; i++)
-	for (head = &buckets[i]; (b = *head);) {
-	    *head = b->next;
-	    free(b);
-	}
+void
+discard_atoms(void)
+/* empty all string, number and blob tables */
+{
+    intern_free(&string_table);
+    intern_free(&number_table);
+    intern_free(&blob_table);
 #ifdef THREADS
     if (threads > 1) {
-	pthread_mutex_unlock(&bucket_mutex);
 	/*
 	 * This is irreversible, and will have to be factored out if
 	 * dicard_atoms() is ever called anywhere but in final cleanup.
 	 */
-	pthread_mutex_destroy(&bucket_mutex);
+	int i;
+
+	pthread_once(&intern_once, intern_init);
+	for (i = 0; i < NSHARDS; i++) {
+	    pthread_mutex_destroy(&string_table.shard[i].mutex);
+	    pthread_mutex_destroy(&number_table.shard[i].mutex);
+	    pthread_mutex_destroy(&blob_table.shard[i].mutex);
+	}
     }
 #endif /* THREADS */
 }
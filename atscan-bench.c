@@ -0,0 +1,143 @@
+/*
+ * Microbenchmark for the @-string scanning kernels in atscan.c.
+ *
+ * Skips every @-string in the masters named on the command line the
+ * way lex.l's string_length() does, once with the byte-at-a-time loop
+ * the lexer used to have and once with each kernel this CPU supports,
+ * and reports the throughput of each.  Run it with "make bench".
+ *
+ *  SPDX-License-Identifier: GPL-2.0+
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "atscan.h"
+
+#define MIN_SECONDS	0.5
+
+typedef struct {
+    char *text;
+    size_t size;
+} master;
+
+static size_t
+skip_bytewise(const char *s, const char *end)
+/* the old lexer loop: test every byte for '@' */
+{
+    const char *p = s + 1;
+
+    while (p < end) {
+	if (*p++ == '@') {
+	    if (p == end || *p != '@')
+		break;
+	    p++;
+	}
+    }
+    return p - s;
+}
+
+static size_t
+skip_kernel(const char *s, const char *end,
+	    const char *(*scan)(const char *, const char *))
+/* what string_length() in lex.l does */
+{
+    const char *p = s + 1;
+
+    while ((p = scan(p, end)) < end) {
+	if (++p == end || *p != '@')
+	    break;
+	p++;
+    }
+    return p - s;
+}
+
+static unsigned long
+walk(const master *m, const char *(*scan)(const char *, const char *))
+/* skip all the @-strings in a master, returning a checksum of their lengths */
+{
+    const char *p = m->text, *end = m->text + m->size;
+    unsigned long sum = 0;
+
+    while ((p = memchr(p, '@', end - p)) != NULL) {
+	size_t n = scan ? skip_kernel(p, end, scan) : skip_bytewise(p, end);
+	sum = sum * 31 + n;
+	p += n;
+    }
+    return sum;
+}
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+bench(const char *name, const master *masters, int nmasters, size_t total,
+      const char *(*scan)(const char *, const char *), unsigned long *check)
+{
+    unsigned long sum = 0;
+    double start, elapsed;
+    long passes = 0;
+    int i;
+
+    for (i = 0; i < nmasters; i++)
+	sum += walk(&masters[i], scan);
+    start = now();
+    do {
+	for (i = 0; i < nmasters; i++)
+	    walk(&masters[i], scan);
+	passes++;
+    } while ((elapsed = now() - start) < MIN_SECONDS);
+
+    printf("%-10s %10.1f MB/s%s\n", name,
+	   total * (double)passes / elapsed / 1e6,
+	   *check && sum != *check ? "  MISMATCH" : "");
+    *check = sum;
+}
+
+int
+main(int argc, char *argv[])
+{
+    master *masters = calloc(argc, sizeof(master));
+    const atscan_kernel *k;
+    unsigned long check = 0;
+    size_t total = 0;
+    int i, n = 0;
+
+    if (argc < 2) {
+	fprintf(stderr, "usage: atscan-bench master,v...\n");
+	return 1;
+    }
+    for (i = 1; i < argc; i++) {
+	FILE *fp = fopen(argv[i], "rb");
+	long size;
+
+	if (fp == NULL || fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0) {
+	    perror(argv[i]);
+	    return 1;
+	}
+	rewind(fp);
+	masters[n].text = malloc(size ? size : 1);
+	masters[n].size = fread(masters[n].text, 1, size, fp);
+	total += masters[n++].size;
+	fclose(fp);
+    }
+    printf("%d masters, %zu bytes\n", n, total);
+
+    bench("bytewise", masters, n, total, NULL, &check);
+    for (k = atscan_kernels; k->name; k++)
+	if (k->usable())
+	    bench(k->name, masters, n, total, k->scan, &check);
+    bench("atscan", masters, n, total, atscan, &check);
+
+    return 0;
+}
+
+/* end */
@@ -0,0 +1,176 @@
+/*
+ * Skipping through RCS @-strings.
+ *
+ * Most of the bytes in a master are inside @-strings, and the lexer only
+ * needs to find the '@' characters in them - either the closing delimiter
+ * or the first half of an @@ escape.  These kernels jump from one '@' to
+ * the next a vector at a time.  The best one the CPU supports is picked
+ * on first use.
+ *
+ *  SPDX-License-Identifier: GPL-2.0+
+ */
+
+#include <string.h>
+
+#include "atscan.h"
+
+static const char *
+atscan_portable(const char *s, const char *end)
+{
+    const char *p = memchr(s, '@', end - s);
+
+    return p ? p : end;
+}
+
+static bool
+atscan_always(void)
+{
+    return true;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <stdint.h>
+#include <immintrin.h>
+
+/*
+ * A short tail is finished with one more vector load, masked down to
+ * the bytes before end.  That reads past end, which is harmless as
+ * long as the load stays inside the page; hence also the sanitizer
+ * exemption.
+ */
+#define PAGE_SIZE_MIN	4096
+#define PAGE_SAFE(s, width) \
+	(((uintptr_t)(s) & (PAGE_SIZE_MIN - 1)) <= PAGE_SIZE_MIN - (width))
+
+#if defined(__has_attribute)
+#if __has_attribute(no_sanitize_address) && __has_attribute(no_sanitize_thread)
+#define NO_SANITIZE __attribute__((no_sanitize_address, no_sanitize_thread))
+#endif
+#endif
+#ifndef NO_SANITIZE
+#define NO_SANITIZE
+#endif
+
+__attribute__((target("sse2"))) NO_SANITIZE
+static const char *
+atscan_sse2(const char *s, const char *end)
+{
+    const __m128i at = _mm_set1_epi8('@');
+    unsigned mask;
+
+    while (end - s >= 16) {
+	mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)s), at));
+	if (mask)
+	    return s + __builtin_ctz(mask);
+	s += 16;
+    }
+    if (s == end)
+	return end;
+    if (!PAGE_SAFE(s, 16))
+	return atscan_portable(s, end);
+    mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)s), at));
+    mask &= (1u << (end - s)) - 1;
+    return mask ? s + __builtin_ctz(mask) : end;
+}
+
+__attribute__((target("avx2"))) NO_SANITIZE
+static const char *
+atscan_avx2(const char *s, const char *end)
+{
+    const __m256i at = _mm256_set1_epi8('@');
+    unsigned mask;
+
+    while (end - s >= 64) {
+	__m256i lo = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)s), at);
+	__m256i hi = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(s + 32)), at);
+	if (_mm256_movemask_epi8(_mm256_or_si256(lo, hi))) {
+	    mask = (unsigned)_mm256_movemask_epi8(lo);
+	    if (mask)
+		return s + __builtin_ctz(mask);
+	    return s + 32 + __builtin_ctz((unsigned)_mm256_movemask_epi8(hi));
+	}
+	s += 64;
+    }
+    while (end - s >= 32) {
+	mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)s), at));
+	if (mask)
+	    return s + __builtin_ctz(mask);
+	s += 32;
+    }
+    if (s == end)
+	return end;
+    if (!PAGE_SAFE(s, 32))
+	return atscan_sse2(s, end);
+    mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)s), at));
+    mask &= (1u << (end - s)) - 1;
+    return mask ? s + __builtin_ctz(mask) : end;
+}
+
+static bool
+atscan_has_sse2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+static bool
+atscan_has_avx2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif /* x86 */
+
+const atscan_kernel atscan_kernels[] = {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    {"avx2", atscan_avx2, atscan_has_avx2},
+    {"sse2", atscan_sse2, atscan_has_sse2},
+#endif /* x86 */
+    {"portable", atscan_portable, atscan_always},
+    {NULL, NULL, NULL},
+};
+
+static const char *atscan_resolve(const char *s, const char *end);
+
+static const char *(*atscan_kernel_fn)(const char *, const char *) = atscan_resolve;
+
+static const char *
+atscan_resolve(const char *s, const char *end)
+/* pick a kernel on first use; racing threads all pick the same one */
+{
+    const atscan_kernel *k;
+
+    for (k = atscan_kernels; !k->usable(); k++)
+	continue;
+    __atomic_store_n(&atscan_kernel_fn, k->scan, __ATOMIC_RELAXED);
+    return k->scan(s, end);
+}
+
+const char *
+atscan(const char *s, const char *end)
+{
+    return __atomic_load_n(&atscan_kernel_fn, __ATOMIC_RELAXED)(s, end);
+}
+
+size_t
+atunescape(char *t, const char *s, size_t length)
+/* copy out the body of an @-string, undoubling @@; t may be s */
+{
+    const char *end = s + length;
+    const char *at;
+    char *start = t;
+
+    for (s++; s < end; s = at + 2) {
+	at = atscan(s, end);
+	memmove(t, s, at - s);
+	t += at - s;
+	/* a single @ closes the string, @@ stands for @ */
+	if (at + 1 >= end || at[1] != '@')
+	    break;
+	*t++ = '@';
+    }
+    *t = '\0';
+    return t - start;
+}
+
+/* end */
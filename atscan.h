@@ -0,0 +1,27 @@
+#ifndef _ATSCAN_H_
+#define _ATSCAN_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* find the first '@' in [s, end), returning end if there is none */
+const char *
+atscan(const char *s, const char *end);
+
+/*
+ * unescape the @-string of the given length (both delimiters included)
+ * at s into t, NUL-terminating it; t needs length - 1 bytes and may be s
+ */
+size_t
+atunescape(char *t, const char *s, size_t length);
+
+/* the kernels atscan() chooses between at runtime, best first */
+typedef struct _atscan_kernel {
+    const char *name;
+    const char *(*scan)(const char *s, const char *end);
+    bool (*usable)(void);
+} atscan_kernel;
+
+extern const atscan_kernel atscan_kernels[];
+
+#endif /* _ATSCAN_H_ */
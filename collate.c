@@ -3,6 +3,10 @@
  *
  *  SPDX-License-Identifier: GPL-2.0+
  */
+#ifdef THREADS
+#include <pthread.h>
+#endif /* THREADS */
+
 #include "cvs.h"
 #include "revdir.h"
 /*
@@ -14,7 +18,10 @@
 /*
  * Pack the dead flag into the commit pointer so we can avoid dereferencing
  * in the inner loop. Also keep the dir near the packed pointer
- * as it is used in the inner loop.
+ * as it is used in the inner loop.  The next bit marks a cursor that
+ * has reached the parent branch; it lives here rather than in the
+ * commit because commits on a parent branch are shared by every
+ * branch collated off it.
  */
 typedef struct _revision {
     /* packed commit pointer and dead flag */
@@ -32,7 +39,9 @@ typedef struct _revision {
 	(rev).dir = (commit)->master->dir;	\
     } while (0)
 #define REVISION_T_DEAD(rev) (((rev).packed) & 1)
-#define COMMIT_MASK (~(uintptr_t)0 ^ 1)
+#define REVISION_T_TAILED(rev) (((rev).packed) & 2)
+#define REVISION_T_SET_TAILED(rev) ((rev).packed |= 2)
+#define COMMIT_MASK (~(uintptr_t)0 ^ 3)
 #define REVISION_T_COMMIT(rev) (cvs_commit *)(((rev).packed) & (COMMIT_MASK))
 
 /*
@@ -40,86 +49,243 @@ typedef struct _revision {
  * is in scope
  */
 #define DEAD(index) (REVISION_T_DEAD(revisions[(index)]))
+#define TAILED(index) (REVISION_T_TAILED(revisions[(index)]))
 #define REVISIONS(index) (REVISION_T_COMMIT(revisions[(index)]))
 #define DIR(index) (revisions[(index)].dir)
+#define LIVE(index) (DEAD(index) ? NULL : REVISIONS(index))
 
-static rev_ref *
-rev_find_head(head_list *rl, const char *name)
-/* find a named branch head in a revlist - used on both CVS and gitspace sides */
+/*
+ * Everything the branch-topology phase needs to know about one branch
+ * name, gathered in a single pass over the masters: the gitspace head
+ * it turns into, and the per-master CVS branches carrying the name,
+ * in master order.  Parent branch names are reached through the CVS
+ * branches' parent links.  See the general note on branch matching
+ * under collate_to_changesets().
+ */
+typedef struct _branch_name {
+    rev_ref		*head;		/* gitspace branch */
+    rev_ref		**refs;		/* CVS branches of this name */
+    int			nref;
+    int			waiting;	/* parents not yet sorted */
+    const cvs_master	*last;		/* last master seen carrying it */
+} branch_name;
+
+typedef struct _branch_index {
+    branch_name		*names;		/* in order of first appearance */
+    int			nnames;
+    rev_ref		**refs;		/* storage for all the names' refs */
+    size_t		nrefs;
+    int			*slots;		/* open-addressed, by name atom */
+    size_t		mask;
+} branch_index;
+
+static size_t
+branch_index_hash(const branch_index *bi, const char *name)
 {
-    rev_ref	*h;
-
-    for (h = rl->heads; h; h = h->next)
-	if (h->ref_name == name)
-	    return h;
-    return NULL;
+    return (size_t)(((uintptr_t)name >> 3) * 2654435761u) & bi->mask;
 }
 
-static rev_ref *
-rev_ref_find_name(rev_ref *h, const char *name)
-/* find a revision reference by name */
+static branch_name *
+branch_index_find(const branch_index *bi, const char *name)
+/* find the entry for a branch name, or NULL */
 {
-    for (; h; h = h->next)
-	if (h->ref_name == name)
-	    return h;
+    size_t i;
+
+    for (i = branch_index_hash(bi, name); bi->slots[i] >= 0;
+	 i = (i + 1) & bi->mask)
+	if (bi->names[bi->slots[i]].head->ref_name == name)
+	    return &bi->names[bi->slots[i]];
     return NULL;
 }
 
-static bool
-parents_in_revlist(const char *child_name, rev_ref *rev_list,
-		   cvs_master *source, size_t nsource)
-/*
- * See whether all the parents of child_name are in rev_list
- * If child_name has no parents (e.g. master branch) then this is
- * trivally true.
- *
- * Parent branch names are determined by examining every cvs master.  See the
- * general note on branch matching under collate_changesets().
- */
+static void
+branch_index_build(branch_index *bi, cvs_master *masters, size_t nmasters)
+/* one pass over the masters to index every branch name they carry */
 {
-    cvs_master *cm;
-    for (cm = source; cm < source + nsource; cm++) {
-	rev_ref *head = rev_find_head(cm, child_name);
-	if (head) {
-	    if (head->parent && !rev_ref_find_name(rev_list, head->parent->ref_name))
-		    return false;
+    cvs_master	*cm;
+    rev_ref	*lh;
+    size_t	total = 0, nslots = 1, i;
+    int		n;
+
+    for (cm = masters; cm < masters + nmasters; cm++)
+	for (lh = cm->heads; lh; lh = lh->next)
+	    total++;
+    while (nslots < 2 * total)
+	nslots <<= 1;
+    bi->names = xcalloc(total ? total : 1, sizeof(branch_name), "branch index");
+    bi->refs = xmalloc((total ? total : 1) * sizeof(rev_ref *), "branch index");
+    bi->slots = xmalloc(nslots * sizeof(int), "branch index");
+    memset(bi->slots, -1, nslots * sizeof(int));
+    bi->mask = nslots - 1;
+    bi->nnames = 0;
+    bi->nrefs = total;
+
+    /*
+     * The gitspace heads are created in order of first appearance,
+     * which is the order the toposort breaks ties in.
+     */
+    n = 0;
+    for (cm = masters; cm < masters + nmasters; cm++) {
+	for (lh = cm->heads; lh; lh = lh->next) {
+	    branch_name *b = branch_index_find(bi, lh->ref_name);
+	    if (!b) {
+		head_list fresh = {NULL};
+		b = &bi->names[bi->nnames];
+		b->head = rev_list_add_head(&fresh, NULL, lh->ref_name, lh->degree);
+		for (i = branch_index_hash(bi, lh->ref_name); bi->slots[i] >= 0;
+		     i = (i + 1) & bi->mask)
+		    continue;
+		bi->slots[i] = bi->nnames++;
+	    } else if (lh->degree > b->head->degree)
+		b->head->degree = lh->degree;
+	    /* a master's first head of a given name is the one used */
+	    if (b->last != cm) {
+		b->last = cm;
+		b->nref++;
+	    }
+	}
+	if (++n % 100 == 0)
+	    progress_jump(n);
+    }
+    progress_jump(n);
+
+    /* now lay out each name's refs, still in master order */
+    for (n = 0, i = 0; n < bi->nnames; n++) {
+	bi->names[n].refs = bi->refs + i;
+	i += bi->names[n].nref;
+	bi->names[n].nref = 0;
+	bi->names[n].last = NULL;
+    }
+    for (cm = masters; cm < masters + nmasters; cm++)
+	for (lh = cm->heads; lh; lh = lh->next) {
+	    branch_name *b = branch_index_find(bi, lh->ref_name);
+	    if (b->last != cm) {
+		b->last = cm;
+		b->refs[b->nref++] = lh;
+	    }
 	}
+}
+
+static void
+branch_index_free(branch_index *bi)
+{
+    free(bi->names);
+    free(bi->refs);
+    free(bi->slots);
+}
+
+static void
+branch_heap_push(int *heap, int *nheap, const int n)
+/* min-heap of name indices, so ties go to first appearance */
+{
+    int i = (*nheap)++;
+
+    while (i > 0 && heap[(i - 1) / 2] > n) {
+	heap[i] = heap[(i - 1) / 2];
+	i = (i - 1) / 2;
     }
-    return true;
+    heap[i] = n;
+}
+
+static int
+branch_heap_pop(int *heap, int *nheap)
+{
+    int top = heap[0], last = heap[--*nheap], i = 0;
+
+    for (;;) {
+	int child = 2 * i + 1;
+	if (child >= *nheap)
+	    break;
+	if (child + 1 < *nheap && heap[child + 1] < heap[child])
+	    child++;
+	if (heap[child] >= last)
+	    break;
+	heap[i] = heap[child];
+	i = child;
+    }
+    heap[i] = last;
+    return top;
 }
 
 static rev_ref *
-rev_ref_tsort(rev_ref *git_branches, cvs_master *masters, size_t nmasters)
-/* Sort a list of git space branches so parents come before children */
+rev_ref_tsort(branch_index *bi)
+/* Sort the gitspace branches so parents come before children */
 {
     rev_ref *sorted_git_branches = NULL;
     rev_ref **sorted_tail = &sorted_git_branches;
-    rev_ref *r, **prev;
-
-    while (git_branches) {
-	/* search the remaining input list */
-	for (prev = &git_branches; (r = *prev); prev = &(*prev)->next) {
-            /*
-	     * Find a branch where we've already sorted its parents.
-	     * Toposorting with this relation will put the (parentless) trunk first,
-	     * and child branches after their respective parent branches.
-	     */
-	    if (parents_in_revlist(r->ref_name, sorted_git_branches, masters, nmasters)) {
-		break;
+    int *seen, *edges, *first, *children, *heap;
+    int nedge = 0, nheap = 0, nsorted = 0, n, i;
+
+    /*
+     * Gather the distinct parent -> child name edges.  A parent name
+     * no master carries a head for can never be sorted, so the child
+     * just waits on it forever and shows up as a cycle, as it should.
+     */
+    seen = xmalloc((bi->nnames + 1) * sizeof(int), "branch sort");
+    heap = xmalloc((bi->nnames + 1) * sizeof(int), "branch sort");
+    edges = xmalloc(2 * (bi->nrefs + 1) * sizeof(int), "branch sort");
+    first = xcalloc(bi->nnames + 1, sizeof(int), "branch sort");
+    for (n = 0; n < bi->nnames; n++)
+	seen[n] = -1;
+    for (n = 0; n < bi->nnames; n++) {
+	branch_name *b = &bi->names[n];
+	b->waiting = 0;
+	for (i = 0; i < b->nref; i++) {
+	    branch_name *p;
+	    if (!b->refs[i]->parent)
+		continue;
+	    p = branch_index_find(bi, b->refs[i]->parent->ref_name);
+	    if (!p) {
+		b->waiting++;
+		continue;
 	    }
+	    if (seen[p - bi->names] == n)
+		continue;
+	    seen[p - bi->names] = n;
+	    b->waiting++;
+	    edges[2 * nedge] = p - bi->names;
+	    edges[2 * nedge + 1] = n;
+	    nedge++;
+	    first[p - bi->names + 1]++;
 	}
-	if (!r) {
-	    announce("internal error - branch cycle\n");
-	    return NULL;
-	}
-        /*
-         * Remove the found branch from the input list and
-         * append it to the output list
-         */
-	*prev = r->next;
+    }
+    for (n = 0; n < bi->nnames; n++)
+	first[n + 1] += first[n];
+    children = xmalloc((nedge + 1) * sizeof(int), "branch sort");
+    for (n = 0; n < bi->nnames; n++)
+	seen[n] = first[n];
+    for (i = 0; i < nedge; i++)
+	children[seen[edges[2 * i]]++] = edges[2 * i + 1];
+
+    /*
+     * Repeatedly take the earliest-appearing branch whose parents have
+     * all been sorted.  This puts the (parentless) trunk first, and
+     * child branches after their respective parent branches.
+     */
+    for (n = 0; n < bi->nnames; n++)
+	if (bi->names[n].waiting == 0)
+	    branch_heap_push(heap, &nheap, n);
+    while (nheap > 0) {
+	rev_ref *r;
+	n = branch_heap_pop(heap, &nheap);
+	r = bi->names[n].head;
 	*sorted_tail = r;
 	r->next = NULL;
 	sorted_tail = &r->next;
+	nsorted++;
+	for (i = first[n]; i < first[n + 1]; i++)
+	    if (--bi->names[children[i]].waiting == 0)
+		branch_heap_push(heap, &nheap, children[i]);
+    }
+
+    free(seen);
+    free(heap);
+    free(edges);
+    free(first);
+    free(children);
+    if (nsorted < bi->nnames) {
+	announce("internal error - branch cycle\n");
+	return NULL;
     }
     return sorted_git_branches;
 }
@@ -127,8 +293,9 @@ rev_ref_tsort(rev_ref *git_branches, cvs_master *masters, size_t nmasters)
 static int
 cvs_commit_date_compare(const void *av, const void *bv)
 {
-    const cvs_commit	*a = REVISION_T_COMMIT(*(revision_t *) av);
-    const cvs_commit	*b = REVISION_T_COMMIT(*(revision_t *) bv);
+    const revision_t	*ra = av, *rb = bv;
+    const cvs_commit	*a = REVISION_T_COMMIT(*ra);
+    const cvs_commit	*b = REVISION_T_COMMIT(*rb);
     int			t;
 
     /*
@@ -143,8 +310,8 @@ cvs_commit_date_compare(const void *av, const void *bv)
     /*
      * tailed entries sort next
      */
-    if (a->tailed != b->tailed)
-	return(int)a->tailed - (int)b->tailed;
+    if (REVISION_T_TAILED(*ra) != REVISION_T_TAILED(*rb))
+	return REVISION_T_TAILED(*ra) ? 1 : -1;
     /*
      * Newest entries sort first
      */
@@ -152,8 +319,13 @@ cvs_commit_date_compare(const void *av, const void *bv)
     if (t)
 	return t;
     /*
-     * Ensure total order by ordering based on commit address
+     * Ensure total order by ordering based on master, then commit
+     * address within the master's commit slab.  The masters are one
+     * array in path order, so unlike raw addresses this doesn't depend
+     * on the order the analysis threads happened to allocate the slabs.
      */
+    if (a->master != b->master)
+	return (uintptr_t) a->master > (uintptr_t) b->master ? -1 : 1;
     if ((uintptr_t) a > (uintptr_t) b)
 	return -1;
     if ((uintptr_t) a < (uintptr_t) b)
@@ -217,13 +389,26 @@ cvs_commitid_match(const cvs_commit *a, const cvs_commit *b)
     return maybe;
 }
 
+static tribool
+cvs_commit_match_metadata(const cvs_commit *a, const cvs_commit *b)
+/* can two commits be coalesced, as far as we can tell without logs? */
+{
+    tribool idcheck = cvs_commitid_match(a, b);
+
+    if (idcheck != maybe)
+	return idcheck;
+    if (!cvs_commit_time_close(a->date, b->date))
+	return no;
+    if (a->author != b->author)
+	return no;
+    return maybe;
+}
+
 static bool
 cvs_commit_match(const cvs_commit *a, const cvs_commit *b)
 /* are two CVS commits eligible to be coalesced into a changeset? */
 {
-    tribool idcheck = cvs_commitid_match(a, b);
-
-    switch (idcheck) {
+    switch (cvs_commit_match_metadata(a, b)) {
     case yes:
 	return true;
     case no:
@@ -232,13 +417,25 @@ cvs_commit_match(const cvs_commit *a, const cvs_commit *b)
 	break;
     }
 
-    if (!cvs_commit_time_close(a->date, b->date))
-	return false;
-    if (a->log != b->log)
-	return false;
-    if (a->author != b->author)
+    /* last, as this may have to go back to the masters for the text */
+    return cvs_commit_log(a) == cvs_commit_log(b);
+}
+
+static bool
+git_commit_match(const git_commit *g, const cvs_commit *part)
+/* could a CVS commit have been coalesced into a gitspace commit? */
+{
+    /* PUNNING: only the common members are looked at */
+    switch (cvs_commit_match_metadata((const cvs_commit *)g, part)) {
+    case yes:
+	return true;
+    case no:
 	return false;
-    return true;
+    case maybe:
+	break;
+    }
+
+    return g->log == cvs_commit_log(part);
 }
 
 /*
@@ -260,11 +457,42 @@ git_commit_cleanup(void)
     }
 }
 
+/*
+ * Repositories have been seen where 1.1 and 1.1.1.1 of a file are used
+ * interchangeably, so matching a tag's revisions to a commit treats
+ * the two as the same revision.
+ */
+static const cvs_number *rev_1_1, *rev_1_1_1_1;
+
+/*
+ * A commit's fingerprint is the sum of a mixed value per file revision
+ * in its snapshot, so it doesn't depend on order and follows a snapshot
+ * built from the one before by adding and subtracting.  Equal revision
+ * sets have equal fingerprints; unequal ones almost never do, so a
+ * tag's set can be checked against a commit without iterating it.
+ */
+static uint64_t
+revision_fingerprint(const cvs_commit *c)
+/* a file revision's share of the fingerprint of a set it's in */
+{
+    uint64_t x;
+
+    if (c->number == rev_1_1 || c->number == rev_1_1_1_1)
+	x = (uintptr_t)c->master;
+    else
+	x = (uintptr_t)c;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
 static git_commit *
-git_commit_build(revision_t *revisions, const cvs_commit *leader, const int nrevisions)
-/* build a changeset commit from a clique of CVS revisions */
+git_commit_alloc(const cvs_commit *leader)
+/* make a changeset commit for a clique led by leader, minus its snapshot */
 {
-    size_t     n;
     git_commit *commit;
 
     commit = xmalloc(sizeof(git_commit), "creating commit");
@@ -272,19 +500,31 @@ git_commit_build(revision_t *revisions, const cvs_commit *leader, const int nrev
     commit->parent = NULL;
     commit->date = leader->date;
     commit->commitid = leader->commitid;
-    commit->log = leader->log;
+    commit->log = cvs_commit_log(leader);
     commit->author = leader->author;
     commit->tail = commit->tailed = false;
     commit->dead = false;
     commit->refcount = commit->serial = 0;
+    commit->fingerprint = 0;
+    return commit;
+}
+
+static git_commit *
+git_commit_build(revdir_packer *packer, revision_t *revisions,
+		 const cvs_commit *leader, const int nrevisions)
+/* build a changeset commit from a clique of CVS revisions */
+{
+    size_t     n;
+    git_commit *commit = git_commit_alloc(leader);
 
-    revdir_pack_init();
+    revdir_pack_init(packer);
     for (n = 0; n < nrevisions; n++) {
 	if (REVISIONS(n) && !(DEAD(n))) {
-	    revdir_pack_add(REVISIONS(n), DIR(n));
+	    revdir_pack_add(packer, REVISIONS(n), DIR(n));
+	    commit->fingerprint += revision_fingerprint(REVISIONS(n));
 	}
     }
-    revdir_pack_end(&commit->revdir);
+    revdir_pack_end(packer, &commit->revdir);
 
 #ifdef ORDERDEBUG
     debugmsg("commit_build: %p\n", commit);
@@ -305,6 +545,74 @@ git_commit_build(revision_t *revisions, const cvs_commit *leader, const int nrev
     return commit;
 }
 
+/*
+ * Successive commits on a branch differ only in the clique that was
+ * stepped between them, so the walk builds their snapshots through a
+ * revdir chain, which repacks just the directories those files are in.
+ * The fingerprint is kept up to date the same way.
+ */
+typedef struct _snapshot_chain {
+    revdir_chain	*revdirs;
+    const cvs_commit	**files;	/* what each slot holds */
+    uint64_t		fingerprint;	/* of what the slots hold */
+} snapshot_chain;
+
+static void
+git_commit_set(snapshot_chain *chain, const int n, const cvs_commit *file)
+/* put a file in a slot of the next snapshot, or empty it with NULL */
+{
+    if (chain->files[n] == file)
+	return;
+    if (chain->files[n])
+	chain->fingerprint -= revision_fingerprint(chain->files[n]);
+    if (file)
+	chain->fingerprint += revision_fingerprint(file);
+    chain->files[n] = file;
+    revdir_chain_set(chain->revdirs, n, file);
+}
+
+static snapshot_chain *
+git_commit_chain(const revision_t *revisions, const int nrevisions)
+/* start a chain of snapshots at the cursors as they stand */
+{
+    const master_dir **dirs = xmalloc(nrevisions * sizeof(master_dir *),
+				      "collating per-file branches");
+    snapshot_chain *chain = xmalloc(sizeof(snapshot_chain),
+				    "collating per-file branches");
+    int n;
+
+    for (n = 0; n < nrevisions; n++)
+	dirs[n] = DIR(n);
+    chain->revdirs = revdir_chain_alloc(dirs, nrevisions);
+    free(dirs);
+    chain->files = xcalloc(nrevisions, sizeof(cvs_commit *),
+			   "collating per-file branches");
+    chain->fingerprint = 0;
+    for (n = 0; n < nrevisions; n++)
+	if (LIVE(n))
+	    git_commit_set(chain, n, LIVE(n));
+    return chain;
+}
+
+static void
+git_commit_chain_free(snapshot_chain *chain)
+{
+    revdir_chain_free(chain->revdirs);
+    free(chain->files);
+    free(chain);
+}
+
+static git_commit *
+git_commit_next(snapshot_chain *chain, const cvs_commit *leader)
+/* build a changeset commit from the cursors the chain has been given */
+{
+    git_commit *commit = git_commit_alloc(leader);
+
+    revdir_chain_pack(chain->revdirs, &commit->revdir);
+    commit->fingerprint = chain->fingerprint;
+    return commit;
+}
+
 static git_commit *
 git_commit_locate_date(const rev_ref *branch, const cvstime_t date)
 /* on branch, locate a commit within fuzz-time distance of date */
@@ -320,79 +628,291 @@ git_commit_locate_date(const rev_ref *branch, const cvstime_t date)
     return NULL;
 }
 
-static git_commit *
-git_commit_locate_one(const rev_ref *branch, const cvs_commit *part)
-/* seek a gitspace commit on branch incorporating cvs_commit */
+/*
+ * Index of the gitspace commits built so far, answering the questions
+ * that used to be walks down parent chains trying git_commit_match()
+ * at every step: which commit on a branch's history does a CVS commit
+ * belong to, and which branch first reaches one.  Commits are hashed
+ * on what a match has to agree on, as the collation queue does, so
+ * the candidates are one key chain; each still gets the full match.
+ *
+ * A commit's place in history is the branch that built it and its
+ * distance from that branch's newest commit.  Each branch records the
+ * already-indexed commit its oldest one continues into, so walking
+ * from any commit is a step along its own branch followed by a hop
+ * per branch below it.  For branch lookups, each commit also records
+ * the first head, in head order, whose walk reaches it.  Commits are
+ * hashed on their fingerprint too, for matching tags.
+ *
+ * A tag search walks down from each head in turn, stopping at the
+ * tagged revision's commit or anything older.  Commits on a branch are
+ * stored in order, each pointing back at the nearest newer one dated
+ * earlier still, so whether a stretch of branch has a commit older
+ * than some date is a few hops back from its oldest end.
+ */
+typedef struct _gitspace_entry {
+    const git_commit	*commit;
+    int			seg;		/* branch that built it, or -1 */
+    int			ord;		/* place on it, newest first */
+    int			head;		/* first head reaching it, or -1 */
+    int			next;		/* next entry with the same key */
+    int			next_print;	/* and with the same fingerprint */
+    int			earlier;	/* nearest newer one dated earlier, or -1 */
+} gitspace_entry;
+
+typedef struct _gitspace_join {
+    int			seg, ord;	/* where a branch continues, or -1 */
+    int			first, len;	/* the branch's entries */
+} gitspace_join;
+
+typedef struct _gitspace_index {
+    gitspace_entry	*entries;
+    int			nentries;
+    int			*slots;		/* entries by commit, open addressed */
+    int			*keys;		/* key chain heads */
+    int			*prints;	/* fingerprint chain heads */
+    size_t		mask;		/* for both tables */
+    gitspace_join	*joins;		/* per branch */
+    int			njoins, sjoins;
+    rev_ref		**heads;	/* by head number */
+    int			nheads, sheads;
+} gitspace_index;
+
+static size_t
+gitspace_slot(const gitspace_index *gi, const git_commit *g)
 {
-    git_commit	*commit;
+    return (size_t)(((uintptr_t)g >> 4) * 2654435761u) & gi->mask;
+}
 
-    if (!branch)
-	return NULL;
+static size_t
+gitspace_key(const gitspace_index *gi, const char *commitid,
+	     const char *author, const char *log)
+/* the key chain holding every commit a match could be found in */
+{
+    uintptr_t h;
 
-    /* PUNNING: see the big comment in cvs.h */
-    for (commit = (git_commit *)branch->commit;
-	 commit;
-	 commit = commit->parent)
-    {
-	/* PUNNING: see the big comment in cvs.h */
-	if (cvs_commit_match((cvs_commit *)commit, part))
-	    return commit;
+    if (trust_commitids && commitid)
+	h = (uintptr_t)commitid >> 3;
+    else
+	h = ((uintptr_t)author >> 3) * 31 + ((uintptr_t)log >> 3);
+    return (size_t)(h * 2654435761u) & gi->mask;
+}
+
+static void
+gitspace_link(gitspace_index *gi, const int e)
+/* put an entry into both tables */
+{
+    const git_commit *g = gi->entries[e].commit;
+    size_t i, k;
+
+    for (i = gitspace_slot(gi, g); gi->slots[i] >= 0; i = (i + 1) & gi->mask)
+	continue;
+    gi->slots[i] = e;
+    k = gitspace_key(gi, g->commitid, g->author, g->log);
+    gi->entries[e].next = gi->keys[k];
+    gi->keys[k] = e;
+    k = (size_t)g->fingerprint & gi->mask;
+    gi->entries[e].next_print = gi->prints[k];
+    gi->prints[k] = e;
+}
+
+static void
+gitspace_index_init(gitspace_index *gi)
+{
+    memset(gi, '\0', sizeof(gitspace_index));
+    gi->mask = 1023;
+    gi->entries = xmalloc((gi->mask + 1) / 2 * sizeof(gitspace_entry),
+			  "gitspace index");
+    gi->slots = xmalloc((gi->mask + 1) * sizeof(int), "gitspace index");
+    gi->keys = xmalloc((gi->mask + 1) * sizeof(int), "gitspace index");
+    gi->prints = xmalloc((gi->mask + 1) * sizeof(int), "gitspace index");
+    memset(gi->slots, -1, (gi->mask + 1) * sizeof(int));
+    memset(gi->keys, -1, (gi->mask + 1) * sizeof(int));
+    memset(gi->prints, -1, (gi->mask + 1) * sizeof(int));
+}
+
+static void
+gitspace_index_free(gitspace_index *gi)
+{
+    free(gi->entries);
+    free(gi->slots);
+    free(gi->keys);
+    free(gi->prints);
+    free(gi->joins);
+    free(gi->heads);
+}
+
+static int
+gitspace_find(const gitspace_index *gi, const git_commit *g)
+/* the entry for a commit, or -1 */
+{
+    size_t i;
+
+    for (i = gitspace_slot(gi, g); gi->slots[i] >= 0; i = (i + 1) & gi->mask)
+	if (gi->entries[gi->slots[i]].commit == g)
+	    return gi->slots[i];
+    return -1;
+}
+
+static int
+gitspace_add(gitspace_index *gi, const git_commit *g, const int seg, const int ord)
+/* index a commit; it must already carry its final metadata */
+{
+    int e;
+
+    if ((size_t)gi->nentries + 1 > (gi->mask + 1) / 2) {
+	gi->mask = 2 * gi->mask + 1;
+	gi->entries = xrealloc(gi->entries,
+			       (gi->mask + 1) / 2 * sizeof(gitspace_entry),
+			       "gitspace index");
+	gi->slots = xrealloc(gi->slots, (gi->mask + 1) * sizeof(int),
+			     "gitspace index");
+	gi->keys = xrealloc(gi->keys, (gi->mask + 1) * sizeof(int),
+			    "gitspace index");
+	gi->prints = xrealloc(gi->prints, (gi->mask + 1) * sizeof(int),
+			      "gitspace index");
+	memset(gi->slots, -1, (gi->mask + 1) * sizeof(int));
+	memset(gi->keys, -1, (gi->mask + 1) * sizeof(int));
+	memset(gi->prints, -1, (gi->mask + 1) * sizeof(int));
+	for (e = 0; e < gi->nentries; e++)
+	    gitspace_link(gi, e);
     }
-    return NULL;
+    e = gi->nentries++;
+    gi->entries[e].commit = g;
+    gi->entries[e].seg = seg;
+    gi->entries[e].ord = ord;
+    gi->entries[e].head = -1;
+    gi->entries[e].earlier = -1;
+    gitspace_link(gi, e);
+    return e;
 }
 
-static git_commit *
-git_commit_locate_any(const rev_ref *branch, const cvs_commit *part)
-/* seek a gitspace commit on *any* branch incorporating cvs_commit */
+static void
+gitspace_add_branch(gitspace_index *gi, const git_commit *newest)
+/* index the commits a branch built, and where the branch continues */
 {
-    git_commit	*commit;
+    const int seg = gi->njoins++, first = gi->nentries;
+    const git_commit *g;
+    int ord = 0, e;
+
+    if (gi->njoins > gi->sjoins) {
+	gi->sjoins = gi->sjoins ? 2 * gi->sjoins : 64;
+	gi->joins = xrealloc(gi->joins, gi->sjoins * sizeof(gitspace_join),
+			     "gitspace index");
+    }
+    for (g = newest; g && gitspace_find(gi, g) < 0; g = g->parent) {
+	int p;
 
-    if (!branch)
-	return NULL;
-    commit = git_commit_locate_any(branch->next, part);
-    if (commit)
-	return commit;
-    return git_commit_locate_one(branch, part);
+	e = gitspace_add(gi, g, seg, ord++);
+	for (p = e - 1; p >= first &&
+		 time_compare(gi->entries[p].commit->date, g->date) >= 0;
+	     p = gi->entries[p].earlier)
+	    continue;
+	gi->entries[e].earlier = p >= first ? p : -1;
+    }
+    gi->joins[seg].first = first;
+    gi->joins[seg].len = ord;
+    gi->joins[seg].seg = gi->joins[seg].ord = -1;
+    if (g) {
+	e = gitspace_find(gi, g);
+	gi->joins[seg].seg = gi->entries[e].seg;
+	gi->joins[seg].ord = gi->entries[e].ord;
+    }
 }
 
-static git_commit *
-git_commit_locate(const rev_ref *branch, const cvs_commit *cm)
+static void
+gitspace_add_head(gitspace_index *gi, rev_ref *h)
+/* take the next head in order, and mark what its walk reaches first */
 {
-    git_commit	*commit;
+    const int n = gi->nheads++;
+    cvs_commit *c;
+    int e;
 
+    if (gi->nheads > gi->sheads) {
+	gi->sheads = gi->sheads ? 2 * gi->sheads : 64;
+	gi->heads = xrealloc(gi->heads, gi->sheads * sizeof(rev_ref *),
+			     "gitspace index");
+    }
+    gi->heads[n] = h;
+    if (h->tail)
+	return;
     /*
-     * Check the presumed trunk first
-     */
-    commit = git_commit_locate_one(branch, cm);
-    if (commit)
-	return commit;
-    /*
-     * Now look through all branches
+     * Once the walk gets somewhere an earlier head got, the rest of
+     * it is that head's walk too.
      */
-    while (branch->parent)
-	branch = branch->parent;
-    return git_commit_locate_any(branch, cm);
+    for (c = h->commit; c; c = c->parent) {
+	/* PUNNING: see the big comment in cvs.h */
+	if ((e = gitspace_find(gi, (git_commit *)c)) < 0)
+	    e = gitspace_add(gi, (git_commit *)c, -1, 0);
+	if (gi->entries[e].head >= 0)
+	    break;
+	gi->entries[e].head = n;
+	if (c->tail)
+	    break;
+    }
 }
 
-static rev_ref *
-git_branch_of_commit(const git_repo *gl, const cvs_commit *commit)
-/* return the gitspace branch head that owns a specified CVS commit */
+static size_t
+gitspace_part_key(const gitspace_index *gi, const cvs_commit *part)
 {
-    rev_ref	*h;
-    cvs_commit	*c;
+    if (trust_commitids && part->commitid)
+	return gitspace_key(gi, part->commitid, NULL, NULL);
+    return gitspace_key(gi, NULL, part->author, cvs_commit_log(part));
+}
 
-    for (h = gl->heads; h; h = h->next)
-    {
-	if (h->tail)
+static git_commit *
+git_commit_locate_one(const gitspace_index *gi,
+		      const rev_ref *branch, const cvs_commit *part)
+/* seek a gitspace commit on branch incorporating cvs_commit */
+{
+    const gitspace_entry *start, *best = NULL;
+    int best_level = 0, e;
+
+    if (!branch || !branch->commit)
+	return NULL;
+    /* PUNNING: see the big comment in cvs.h */
+    e = gitspace_find(gi, (git_commit *)branch->commit);
+    assert(e >= 0);
+    start = &gi->entries[e];
+
+    /* of the matches on the branch's history, take the newest */
+    for (e = gi->keys[gitspace_part_key(gi, part)]; e >= 0; e = gi->entries[e].next) {
+	const gitspace_entry *m = &gi->entries[e];
+	int seg = start->seg, from = start->ord, level = 0;
+
+	if (m->seg < 0 || !git_commit_match(m->commit, part))
 	    continue;
-	for (c = h->commit; c; c = c->parent) {
-	    if (cvs_commit_match(c, commit))
-		return h;
-	    if (c->tail)
-		break;
+	while (seg >= 0 && (seg != m->seg || m->ord < from)) {
+	    const gitspace_join *j = &gi->joins[seg];
+	    seg = j->seg;
+	    from = j->ord;
+	    level++;
+	}
+	if (seg < 0)
+	    continue;
+	if (!best || level < best_level ||
+	    (level == best_level && m->ord < best->ord)) {
+	    best = m;
+	    best_level = level;
 	}
     }
-    return NULL;
+    return best ? (git_commit *)best->commit : NULL;
+}
+
+static rev_ref *
+git_branch_of_commit(const gitspace_index *gi, const cvs_commit *commit)
+/* return the gitspace branch head that owns a specified CVS commit */
+{
+    int head = -1, e;
+
+    for (e = gi->keys[gitspace_part_key(gi, commit)]; e >= 0; e = gi->entries[e].next) {
+	const gitspace_entry *m = &gi->entries[e];
+
+	if (m->head >= 0 && (head < 0 || m->head < head) &&
+	    git_commit_match(m->commit, commit))
+	    head = m->head;
+    }
+    return head >= 0 ? gi->heads[head] : NULL;
 }
 
 static cvstime_t
@@ -404,27 +924,233 @@ cvs_commit_first_date(cvs_commit *commit)
     return commit->date;
 }
 
+/*
+ * The per-master cursors collate_branches() walks down.  Cursors that
+ * are neither dead-ended nor tailed sit in a max-heap on date, so the
+ * leader of each changeset is at the top; ties go to the lower index,
+ * which is the commit a front-to-back scan would have picked.
+ *
+ * Cursors are also hashed on what a clique has to agree on: the
+ * commitid when there is one to trust, otherwise the interned author
+ * and log message.  Everything that can coalesce with the leader is
+ * then on the leader's own chain, and collecting a clique is a walk
+ * down that chain checking the time window, rather than a match
+ * against every master on the branch.
+ */
+typedef struct _cursor_queue {
+    const revision_t	*revisions;
+    int			*heap;		/* cursor indices, newest first */
+    int			*slot;		/* heap position per cursor */
+    int			nheap;
+    int			live;		/* heap cursors with history left */
+    int			*next, *prev;	/* per-cursor chain links */
+    unsigned		*bucket;	/* per-cursor chain */
+    int			*chains;	/* chain heads */
+    unsigned		mask;
+} cursor_queue;
+
+#define CURSOR(q, n)	(REVISION_T_COMMIT((q)->revisions[(n)]))
+
+static bool
+cursor_before(const cursor_queue *q, const int a, const int b)
+/* does cursor a belong nearer the top of the heap than cursor b? */
+{
+    long t = time_compare(CURSOR(q, a)->date, CURSOR(q, b)->date);
+
+    return t > 0 || (t == 0 && a < b);
+}
+
+static void
+cursor_place(cursor_queue *q, int i, const int n)
+/* move cursor n into heap position i, shifting it up or down as needed */
+{
+    while (i > 0 && cursor_before(q, n, q->heap[(i - 1) / 2])) {
+	q->heap[i] = q->heap[(i - 1) / 2];
+	q->slot[q->heap[i]] = i;
+	i = (i - 1) / 2;
+    }
+    for (;;) {
+	int child = 2 * i + 1;
+	if (child >= q->nheap)
+	    break;
+	if (child + 1 < q->nheap &&
+	    cursor_before(q, q->heap[child + 1], q->heap[child]))
+	    child++;
+	if (!cursor_before(q, q->heap[child], n))
+	    break;
+	q->heap[i] = q->heap[child];
+	q->slot[q->heap[i]] = i;
+	i = child;
+    }
+    q->heap[i] = n;
+    q->slot[n] = i;
+}
+
+static unsigned
+cursor_bucket(const cursor_queue *q, const cvs_commit *c)
+/* the chain holding every cursor a commit could coalesce with */
+{
+    uintptr_t h;
+
+    if (trust_commitids && c->commitid)
+	h = (uintptr_t)c->commitid >> 3;
+    else
+	h = ((uintptr_t)c->author >> 3) * 31
+	    + ((uintptr_t)cvs_commit_log(c) >> 3);
+    return (unsigned)(h * 2654435761u) & q->mask;
+}
+
+static void
+cursor_queue_init(cursor_queue *q, const revision_t *revisions, const int n)
+/* set up an empty queue for the cursors in revisions */
+{
+    unsigned nchain = 1;
+
+    while (nchain < 2 * (unsigned)n)
+	nchain <<= 1;
+    q->revisions = revisions;
+    q->heap = xmalloc(4 * n * sizeof(int), "collation queue");
+    q->slot = q->heap + n;
+    q->next = q->slot + n;
+    q->prev = q->next + n;
+    q->bucket = xmalloc(n * sizeof(unsigned), "collation queue");
+    q->chains = xmalloc(nchain * sizeof(int), "collation queue");
+    memset(q->chains, -1, nchain * sizeof(int));
+    q->mask = nchain - 1;
+    q->nheap = q->live = 0;
+}
+
+static void
+cursor_queue_free(cursor_queue *q)
+{
+    free(q->heap);
+    free(q->bucket);
+    free(q->chains);
+}
+
+static void
+cursor_insert(cursor_queue *q, const int n)
+/* add cursor n, which must be neither null nor tailed */
+{
+    const cvs_commit *c = CURSOR(q, n);
+    int *chain;
+
+    if (c->parent || !c->dead)
+	q->live++;
+    cursor_place(q, q->nheap++, n);
+    q->bucket[n] = cursor_bucket(q, c);
+    chain = &q->chains[q->bucket[n]];
+    q->prev[n] = -1;
+    q->next[n] = *chain;
+    if (*chain >= 0)
+	q->prev[*chain] = n;
+    *chain = n;
+}
+
 static void
-collate_branches(rev_ref **branches, int nbranch,
-		  rev_ref *branch, git_repo *gl)
+cursor_remove(cursor_queue *q, const int n)
+/* take cursor n out; must be called before its commit is stepped */
+{
+    const cvs_commit *c = CURSOR(q, n);
+    int last = q->heap[--q->nheap];
+
+    if (c->parent || !c->dead)
+	q->live--;
+    if (last != n)
+	cursor_place(q, q->slot[n], last);
+    if (q->prev[n] >= 0)
+	q->next[q->prev[n]] = q->next[n];
+    else
+	q->chains[q->bucket[n]] = q->next[n];
+    if (q->next[n] >= 0)
+	q->prev[q->next[n]] = q->prev[n];
+}
+
+static int
+cursor_clique(const cursor_queue *q, const int leader, int *clique)
+/* gather into clique the cursors whose commits coalesce with the leader */
+{
+    const cvs_commit *latest = CURSOR(q, leader);
+    int nclique = 0, i;
+
+    /* the chain is a hash bucket, so everything still gets the full check */
+    for (i = q->chains[q->bucket[leader]]; i >= 0; i = q->next[i]) {
+	const cvs_commit *c = CURSOR(q, i);
+	if (c == latest || cvs_commit_match(c, latest))
+	    clique[nclique++] = i;
+    }
+    return nclique;
+}
+
+/*
+ * The collation of one gitspace branch, in two parts.  The walk down
+ * its CVS branches only reads the CVS side, and the commits it builds
+ * are its own, so different branches can be walked at the same time.
+ * The graft onto the parent gitspace branch looks at the parent's
+ * commits and, when a join can't be found, at every branch already
+ * grafted; grafts are done one at a time in toposorted order, which
+ * keeps the result identical to collating the branches sequentially.
+ *
+ * Anything the walk would have announced, or written into the CVS
+ * commits, is held here until the branch is grafted, so it comes out
+ * in the same order too.
+ */
+typedef struct _gitspace_claim {
+    cvs_commit		*cvs;
+    git_commit		*git;
+} gitspace_claim;
+
+typedef struct _collation {
+    rev_ref		*branch;	/* the gitspace branch */
+    rev_ref		**branches;	/* its CVS branch in each master */
+    int			nbranch;
+    revision_t		*revisions;	/* cursors where the walk stopped */
+    int			nset;		/* cursors set on the last step */
+    git_commit		*head, *prev;	/* newest and oldest commits built */
+    const cvs_commit	**late;		/* tips older than the branch join */
+    int			nlate;
+    gitspace_claim	*claims;	/* gitspace backlinks to set */
+    size_t		nclaims, sclaims;
+} collation;
+
+static void
+collation_claim(collation *col, cvs_commit *cvs, git_commit *git)
+/* note a CVS commit as part of a gitspace commit */
+{
+    if (col->nclaims == col->sclaims) {
+	col->sclaims = col->sclaims ? col->sclaims * 2 : 64;
+	col->claims = xrealloc(col->claims,
+			       col->sclaims * sizeof(gitspace_claim),
+			       "collation claims");
+    }
+    col->claims[col->nclaims].cvs = cvs;
+    col->claims[col->nclaims].git = git;
+    col->nclaims++;
+}
+
+static void
+collate_branches(collation *col)
 /* collate a set of per-CVS-master branches into a gitspace DAG branch */
 {
-    int nlive;
+    rev_ref **branches = col->branches;
+    const int nbranch = col->nbranch;
+    int nlive, nset, nrevs, nclique;
     int n;
-    git_commit *prev = NULL;
-    git_commit *head = NULL, **tail = &head;
+    git_commit **tail = &col->head;
     revision_t *revisions = xmalloc(nbranch * sizeof(revision_t), "collating per-file branches");
     git_commit *commit;
     cvs_commit *latest;
-    revision_t *p;
+    cursor_queue queue;
+    snapshot_chain *chain;
+    int *clique;
     time_t birth = 0;
 
     /*
      * It is expected that the array of input branches is all CVS branches
      * tagged with some single branch name. The job of this code is to
-     * build the changeset sequence for the corresponding named git branch,
-     * then graft it to its parent git branch.  Note that the main loop walks
-     * backwards from each branch tip.
+     * build the changeset sequence for the corresponding named git branch;
+     * collate_graft() then grafts it to its parent git branch.  Note that
+     * the main loop walks backwards from each branch tip.
      */
     nlive = 0;
     for (n = 0; n < nbranch; n++) {
@@ -444,7 +1170,7 @@ collate_branches(rev_ref **branches, int nbranch,
 	if (!c)
 	    continue;
 	if (branches[n]->tail) {
-	    c->tailed = true;
+	    REVISION_T_SET_TAILED(revisions[n]);
 	    continue;
 	}
 	nlive++;
@@ -477,13 +1203,16 @@ collate_branches(rev_ref **branches, int nbranch,
      */
     for (n = 0; n < nbranch; n++) {
 	cvs_commit *c = REVISIONS(n);
-	if (!c->tailed)
+	if (!TAILED(n))
 	    continue;
 	if (!birth || time_compare(birth, c->date) >= 0)
 	    continue;
 	if (!c->dead) {
-	    warn("warning - %s branch %s: tip commit older than imputed branch join\n",
-		     c->master->name, branch->ref_name);
+	    /* warned about when the branch is grafted */
+	    if (!col->late)
+		col->late = xmalloc(nbranch * sizeof(cvs_commit *),
+				    "collating per-file branches");
+	    col->late[col->nlate++] = c;
 	    continue;
 	}
 
@@ -491,31 +1220,36 @@ collate_branches(rev_ref **branches, int nbranch,
 	REVISION_T_PACK(revisions[n], (cvs_commit *)NULL);
     }
 
+    /*
+     * Queue up the cursors that haven't reached the parent branch.
+     * Null entries stay in place rather than being squeezed out, so
+     * the surviving revisions keep their relative order.
+     */
+    cursor_queue_init(&queue, revisions, nbranch);
+    clique = xmalloc(nbranch * sizeof(int), "collating per-file branches");
+    nrevs = 0;
+    for (n = 0; n < nbranch; n++) {
+	if (!REVISIONS(n))
+	    continue;
+	nrevs++;
+	if (!TAILED(n))
+	    cursor_insert(&queue, n);
+    }
+    chain = git_commit_chain(revisions, nbranch);
+
     /*
      * Walk down CVS branches creating gitspace commits until each CVS
      * branch has collated with its parent.
      */
-    while (nlive > 0 && nbranch > 0) {
+    nset = nbranch;
+    while (nlive > 0 && nset > 0) {
+	nset = nrevs;
 	/*
-	 * Gather the next set of CVS commits down the branch and
-	 * figure out which (non-tailed) one of them is latest in
-	 * time.  It will be the leader for the git commit build.
+	 * The newest (non-tailed) CVS commit left on any of the
+	 * branches is the leader for the git commit build.
 	 */
-	for (n = 0, p = revisions, latest = NULL; n < nbranch; n++) {
-	    /*
-	     * Squeeze null commit pointers out of the current set.
-	     */
-	    cvs_commit *rev = REVISIONS(n);
-	    if (!rev)
-		continue;
-	    *p++ = revisions[n];
-	    if (rev->tailed)
-		continue;
-	    if (!latest || time_compare(latest->date, rev->date) < 0)
-		latest = rev;
-	}
-	assert(latest != NULL);
-	nbranch = p - revisions;
+	assert(queue.nheap > 0);
+	latest = CURSOR(&queue, queue.heap[0]);
 
 	/*
 	 * Construct current commit from the set of CVS commits
@@ -523,34 +1257,25 @@ collate_branches(rev_ref **branches, int nbranch,
 	 * This is the point at which revisions needs to be sorted
 	 * by master for rev dir packing to perform reasonably.
 	 */
-	commit = git_commit_build(revisions, latest, nbranch);
+	commit = git_commit_next(chain, latest);
 
 	/*
-	 * Step down each CVS branch in parallel.  Our goal is to land on
-	 * a clique of matching CVS commits that will  be made into a
-	 * matching gitspace commit on the next time around the loop.
+	 * Step down the CVS branches in the leader's clique.  Our goal
+	 * is to land on a clique of matching CVS commits that will be
+	 * made into a matching gitspace commit on the next time around
+	 * the loop.  Cursors outside the clique stay put, and only
+	 * the ones that still have history left count as live.
 	 */
-	nlive = 0;
-	for (n = 0; n < nbranch; n++) {
-	    cvs_commit *c = REVISIONS(n);
-	    cvs_commit *to;
-	    /* already got to parent branch? */
-	    if (c->tailed)
-		continue;
-	    /* not affected? */
-	    if (c != latest && !cvs_commit_match(c, latest)) {
-		if (c->parent || !c->dead)
-		    nlive++;
-		continue;
-	    }
-#ifdef GITSPACEDEBUG
-	    if (c->gitspace) {
-		warn("CVS commit allocated to multiple git commits: ");
-		dump_number_file(LOGFILE, c->master->name, c->number);
-		warn("\n");
-	    } else
-#endif /* GITSPACEDEBUG */
-		c->gitspace = commit;
+	nclique = cursor_clique(&queue, queue.heap[0], clique);
+	for (n = 0; n < nclique; n++)
+	    cursor_remove(&queue, clique[n]);
+	nlive = queue.live;
+	while (nclique > 0) {
+	    cvs_commit *c, *to;
+
+	    n = clique[--nclique];
+	    c = REVISIONS(n);
+	    collation_claim(col, c, commit);
 
 	    to = c->parent;
 	    /*
@@ -560,6 +1285,7 @@ collate_branches(rev_ref **branches, int nbranch,
 	    if (!to)
 		goto Kill;
 
+	    REVISION_T_PACK(revisions[n], to);
 	    if (c->tail) {
 		/*
 		 * Adding file independently added on another
@@ -581,7 +1307,7 @@ collate_branches(rev_ref **branches, int nbranch,
 		 * branch had forked off it but before
 		 * our branch's creation.
 		 */
-		to->tailed = true;
+		REVISION_T_SET_TAILED(revisions[n]);
 	    } else if (!to->dead) {
 		nlive++;
 	    } else {
@@ -601,16 +1327,56 @@ collate_branches(rev_ref **branches, int nbranch,
 	     * tests for tailed commits. Leave it in the set for the next
 	     * changeset construction.
 	     */
-	    REVISION_T_PACK(revisions[n], to);
-	    continue;
+	    if (!TAILED(n))
+		cursor_insert(&queue, n);
+	    goto Moved;
 	Kill:
 	    // cppcheck-suppress nullPointer
 	    REVISION_T_PACK(revisions[n], (cvs_commit *)NULL);
+	    nrevs--;
+	Moved:
+	    git_commit_set(chain, n, LIVE(n));
 	}
 
 	*tail = commit;
 	tail = &commit->parent;
-	prev = commit;
+	col->prev = commit;
+    }
+    cursor_queue_free(&queue);
+    free(clique);
+    git_commit_chain_free(chain);
+
+    col->revisions = revisions;
+    col->nset = nset;
+}
+
+static void
+collate_graft(collation *col, revdir_packer *packer, gitspace_index *gi)
+/* connect a walked gitspace branch to its parent branch */
+{
+    rev_ref *branch = col->branch;
+    revision_t *revisions = col->revisions;
+    int nbranch = col->nbranch;
+    const int nset = col->nset;
+    git_commit *prev = col->prev;
+    git_commit **tail = prev ? &prev->parent : &col->head;
+    size_t i;
+    int n;
+
+    for (n = 0; n < col->nlate; n++)
+	warn("warning - %s branch %s: tip commit older than imputed branch join\n",
+	     col->late[n]->master->name, branch->ref_name);
+
+    for (i = 0; i < col->nclaims; i++) {
+	cvs_commit *c = col->claims[i].cvs;
+#ifdef GITSPACEDEBUG
+	if (c->gitspace) {
+	    warn("CVS commit allocated to multiple git commits: ");
+	    dump_number_file(LOGFILE, c->master->name, c->number);
+	    warn("\n");
+	} else
+#endif /* GITSPACEDEBUG */
+	    c->gitspace = col->claims[i].git;
     }
 
     /*
@@ -648,14 +1414,14 @@ collate_branches(rev_ref **branches, int nbranch,
 	     * the last commit.
 	     */
 	    *tail = NULL;
-	else if ((*tail = git_commit_locate_one(branch->parent,
+	else if ((*tail = git_commit_locate_one(gi, branch->parent,
 						REVISIONS(present))))
 	{
 	    if (prev && time_compare((*tail)->date, prev->date) > 0) {
 		cvs_commit *first;
 		warn("warning - branch point %s -> %s later than branch\n",
 			 branch->ref_name, branch->parent->ref_name);
-		warn("\ttrunk(%3d):  %s %s", n,
+		warn("\ttrunk(%3d):  %s %s", nset,
 		     cvstime2rfc3339(REVISIONS(present)->date),
 		     DEAD(present) ? "D" : " " );
 		if (!DEAD(present))
@@ -671,7 +1437,7 @@ collate_branches(rev_ref **branches, int nbranch,
 		 * commit is the right one for purposes of this message.
 		 * (uniform warn messages jw 20151122)
 		 */
-		warn("\tbranch(%3d): %s  ", n,
+		warn("\tbranch(%3d): %s  ", nset,
 		    cvstime2rfc3339(prev->date));
 		revdir_iter *ri = revdir_iter_alloc(&prev->revdir);
 		first = revdir_iter_next(ri);
@@ -690,7 +1456,7 @@ collate_branches(rev_ref **branches, int nbranch,
 	    warn("error - branch point %s -> %s not found.",
 		branch->ref_name, branch->parent->ref_name);
 
-	    if ((lost = git_branch_of_commit(gl, REVISIONS(present))))
+	    if ((lost = git_branch_of_commit(gi, REVISIONS(present))))
 		warn(" Possible match on %s.", lost->ref_name);
 	    fprintf(LOGFILE, "\n");
 	}
@@ -698,7 +1464,7 @@ collate_branches(rev_ref **branches, int nbranch,
 	    if (prev)
 		prev->tail = true;
 	} else {
-	    *tail = git_commit_build(revisions, REVISIONS(0), nbranch);
+	    *tail = git_commit_build(packer, revisions, REVISIONS(0), nbranch);
 	    for (n = 0; n < nbranch; n++)
 		if (REVISIONS(n)) {
 #ifdef GITSPACEDEBUG
@@ -715,40 +1481,34 @@ collate_branches(rev_ref **branches, int nbranch,
 	}
     }
 
-    for (n = 0; n < nbranch; n++)
-	if (REVISIONS(n))
-	    REVISIONS(n)->tailed = false;
-
     free(revisions);
+    free(col->late);
+    free(col->claims);
     /* PUNNING: see the big comment in cvs.h */
-    branch->commit = (cvs_commit *)head;
+    branch->commit = (cvs_commit *)col->head;
+    gitspace_add_branch(gi, col->head);
 }
 
 static bool
-git_commit_contains_revs(git_commit *g, cvs_commit **revs, size_t nrev)
+git_commit_contains_revs(const git_commit *g, cvs_commit **revs, size_t nrev,
+			 const uint64_t fingerprint)
 /* Check whether the commit is made up of the supplied file list.
  * List mut be sorted in path_deep_compare order.
  */
 {
-    revdir_iter *it = revdir_iter_alloc(&g->revdir);
+    revdir_iter *it;
     size_t i = 0;
     cvs_commit *c = NULL;
-    static bool n_init = false;
-    static const cvs_number *n1 = NULL;
-    static const cvs_number *n2 = NULL;
-
-    if (!n_init) {
-	n1 = atom_cvs_number(lex_number("1.1"));
-	n2 = atom_cvs_number(lex_number("1.1.1.1"));
-	n_init = true;
-    }
+
+    if (g->fingerprint != fingerprint)
+	return false;
+    it = revdir_iter_alloc(&g->revdir);
     /* order of checks is important */
     while ((c = revdir_iter_next(it)) && i < nrev) {
 	if (revs[i] != c) {
-	    // seen repos where 1.1 and 1.1.1.1 are used interchangeably
 	    if (revs[i]->master != c->master
-		|| (revs[i]->number != n1 && revs[i]->number != n2)
-		|| (c->number != n1 && c->number != n2)) {
+		|| (revs[i]->number != rev_1_1 && revs[i]->number != rev_1_1_1_1)
+		|| (c->number != rev_1_1 && c->number != rev_1_1_1_1)) {
 		free(it);
 		return false;
 	    }
@@ -761,6 +1521,66 @@ git_commit_contains_revs(git_commit *g, cvs_commit **revs, size_t nrev)
 
 }
 
+static bool
+gitspace_pruned(const gitspace_index *gi, const int seg, const int from,
+		const int to, const git_commit *gitspace,
+		const gitspace_entry *stop)
+/* would a tag walk stop somewhere in a stretch of branch? */
+{
+    const int first = gi->joins[seg].first;
+    int e;
+
+    if (stop && stop->seg == seg && stop->ord >= from && stop->ord <= to)
+	return true;
+    for (e = first + to; e >= first + from; e = gi->entries[e].earlier)
+	if (time_compare(gi->entries[e].commit->date, gitspace->date) < 0)
+	    return true;
+    return false;
+}
+
+static bool
+gitspace_reaches(const gitspace_index *gi, const rev_ref *h,
+		 const gitspace_entry *m, const git_commit *gitspace,
+		 const gitspace_entry *stop, int *level)
+/* does a tag walk from h get to m, and after how many branches? */
+{
+    const gitspace_entry *at;
+    int seg, from, e;
+
+    if (h->tail || !h->commit)
+	return false;
+    /* PUNNING: see the big comment in cvs.h */
+    at = &gi->entries[gitspace_find(gi, (git_commit *)h->commit)];
+    *level = 0;
+    /* synthetic tag commits are on no branch, so step over them */
+    while (at->seg < 0) {
+	const git_commit *g = at->commit;
+
+	if (g == gitspace || time_compare(g->date, gitspace->date) < 0)
+	    return false;
+	if (at == m)
+	    return true;
+	if (!g->parent || (e = gitspace_find(gi, g->parent)) < 0)
+	    return false;
+	at = &gi->entries[e];
+	++*level;
+    }
+    for (seg = at->seg, from = at->ord;; ++*level) {
+	const gitspace_join *j = &gi->joins[seg];
+	const bool here = seg == m->seg && m->ord >= from;
+
+	if (gitspace_pruned(gi, seg, from, here ? m->ord : j->len - 1,
+			    gitspace, stop))
+	    return false;
+	if (here)
+	    return true;
+	if (j->seg < 0)
+	    return false;
+	seg = j->seg;
+	from = j->ord;
+    }
+}
+
 static int
 compare_cvs_commit(const void *a, const void *b)
 {
@@ -776,11 +1596,72 @@ compare_cvs_commit(const void *a, const void *b)
     return path_deep_compare(af, bf);
 }
 
+/*
+ * Tags are located in two passes.  Looking for a commit that is
+ * already in gitspace only reads the DAG, so rev_tag_search() runs
+ * for all the tags at once on the --threads pool.  The tags it finds
+ * nothing for then go through rev_tag_branch() one at a time in tag
+ * order, which is the only place the DAG gets written.  A synthetic
+ * branch goes on the end of the head list, after every head the first
+ * pass searched, so searching the synthetic branches made for earlier
+ * tags there gives each tag what a single pass over the tags did.
+ */
+typedef struct _tag_search {
+    tag_t	*tag;
+    cvs_commit	**revisions;	/* sorted; NULL if the tag is lost */
+    cvs_commit	*latest;	/* newest live revision, if any */
+    uint64_t	fingerprint;	/* of revisions */
+} tag_search;
+
+static git_commit *
+rev_tag_locate(const tag_search *ts, const gitspace_index *gi, const int first)
+/* seek the tag's revision set as a walk down the heads from first would */
+{
+    const git_commit *gitspace = ts->latest->gitspace;
+    const gitspace_entry *stop = NULL, *best = NULL;
+    int best_head = 0, best_level = 0, e;
+
+    /*
+     * The walk tries each head in turn, going down from it until it
+     * gets to c->gitspace or an older commit, and takes the first
+     * commit with the tag's revisions.  Rather than walk, take each
+     * commit whose fingerprint matches, look for the first head that
+     * gets to it unpruned, starting with the first to get to it at
+     * all, and keep whichever the walk would have come to first.
+     */
+    if ((e = gitspace_find(gi, gitspace)) >= 0)
+	stop = &gi->entries[e];
+    for (e = gi->prints[(size_t)ts->fingerprint & gi->mask]; e >= 0;
+	 e = gi->entries[e].next_print) {
+	const gitspace_entry *m = &gi->entries[e];
+	int h, level;
+
+	if (m->head < 0 || !git_commit_contains_revs(m->commit, ts->revisions,
+						     ts->tag->count,
+						     ts->fingerprint))
+	    continue;
+	for (h = m->head > first ? m->head : first; h < gi->nheads; h++) {
+	    if (best && h > best_head)
+		break;
+	    if (!gitspace_reaches(gi, gi->heads[h], m, gitspace, stop, &level))
+		continue;
+	    if (!best || h < best_head || level < best_level ||
+		(level == best_level && m->ord < best->ord)) {
+		best = m;
+		best_head = h;
+		best_level = level;
+	    }
+	    break;
+	}
+    }
+    return best ? (git_commit *)best->commit : NULL;
+}
+
 /*
  * Locate position in git tree corresponding to specific tag
  */
 static void
-rev_tag_search(tag_t *tag, cvs_commit **revisions, git_repo *gl)
+rev_tag_search(tag_search *ts, const gitspace_index *gi)
 {
     /*
      * The cvs_commit->gitspace pointer gives the first git commit a
@@ -799,8 +1680,8 @@ rev_tag_search(tag_t *tag, cvs_commit **revisions, git_repo *gl)
      * If not, we search the whole tree (pruning where possible)
      * for a matching set of revisions.
      *
-     * If this doesn't work we create branch from G with a single
-     * commit with the correct revisions.
+     * If this doesn't work rev_tag_branch() creates a branch from G
+     * with a single commit with the correct revisions.
      *
      * It is possible for multiple git commits to contain the same
      * set of cvs revisions.
@@ -808,8 +1689,44 @@ rev_tag_search(tag_t *tag, cvs_commit **revisions, git_repo *gl)
      * Tags can point to dead commits, we ignore these as they
      * don't get backlinks to git commits. This may get revisited later.
      */
-    cvs_commit *c = cvs_commit_latest(revisions, tag->count);
-    if (!c)	/* only dead revisions in the tag */
+    tag_t *tag = ts->tag;
+    cvs_commit *c;
+    size_t i;
+
+    ts->revisions = tagged(tag);
+    if (!ts->revisions)
+	return;
+    c = ts->latest = cvs_commit_latest(ts->revisions, tag->count);
+    if (!c || !c->gitspace)
+	return;
+
+    for (i = 0; i < tag->count; i++)
+	ts->fingerprint += revision_fingerprint(ts->revisions[i]);
+    qsort(ts->revisions, tag->count, sizeof(cvs_commit *), compare_cvs_commit);
+    if (git_commit_contains_revs(c->gitspace, ts->revisions, tag->count,
+				 ts->fingerprint)) {
+	/* we've seen this set of revisions before, just link tag to it */
+	tag->commit = c->gitspace;
+    } else {
+	/* Search to try and find a matching git commit */
+	tag->commit = rev_tag_locate(ts, gi, 0);
+    }
+}
+
+static void
+rev_tag_branch(tag_search *ts, rev_ref **last, const int nsearched,
+	       revdir_packer *packer, gitspace_index *gi)
+/* finish locating a tag, making a synthetic branch for it if need be */
+{
+    tag_t *tag = ts->tag;
+    cvs_commit *c = ts->latest;
+    size_t i;
+
+    if (!ts->revisions) {
+	announce("internal error - lost tag %s\n", tag->name);
+	return;
+    }
+    if (!c || tag->commit)	/* only dead revisions, or found */
 	return;
     if (c->gitspace == NULL) {
 	char buf[CVS_MAX_REV_LEN + 1];
@@ -819,47 +1736,17 @@ rev_tag_search(tag_t *tag, cvs_commit **revisions, git_repo *gl)
 	     tag->name);
 	return;
     }
-
-    qsort(revisions, tag->count, sizeof(cvs_commit *), compare_cvs_commit);
-    if (git_commit_contains_revs(c->gitspace, revisions, tag->count)) {
-	/* we've seen this set of revisions before, just link tag to it */
-	tag->commit = c->gitspace;
+    /*
+     * The first pass searched the first nsearched heads.  This can
+     * also find revisions in the branches we add below.
+     *
+     * Emacs has one place with 35 tags pointing to the same
+     * revision set, so this saves 34 branches.
+     */
+    if (nsearched < gi->nheads &&
+	(tag->commit = rev_tag_locate(ts, gi, nsearched)))
 	return;
-    } else {
-	/* Search to try and find a matching git commit.
-	 * We can prune if we get to c->gitspace.
-         * We can prune if we get to an older commit than c->gitspace.
-         * We could also use tail-bits here to avoid checking the same
-         * commit multiple times, but we haven't built them yet.
-         * If we build them before tagging we would need to teach
-         * this code how to write correct tail bits in the branches it
-         * creates.
-	 *
-	 * This section can also find revisions in the branches
-	 * we add below.
-	 *
-	 * Emacs has one place with 35 tags pointing to the same
-	 * revision set, so this saves 34 branches.
-	 */
-	rev_ref    *h;
-	git_commit *g;
 
-	for (h = gl->heads; h; h = h->next) {
-	    if (h->tail)
-		continue;
-	    /* PUNNING: See large comment in cvs.h */
-	    for (g = (git_commit *)h->commit; g; g = g->parent) {
-		if (g == c->gitspace)
-		    break;
-		if (time_compare(g->date, c->gitspace->date) < 0)
-		    break;
-		if (git_commit_contains_revs(g, revisions, tag->count)) {
-		    tag->commit = g;
-		    return;
-		}
-	    }
-	}
-    }
     /* Tagging mechanism for incomplete tags
      *
      * The tag doesn't point to a previously seen set of revisions.
@@ -872,55 +1759,51 @@ rev_tag_search(tag_t *tag, cvs_commit **revisions, git_repo *gl)
      * We have no way of knowing the correct author of a tag.
      */
     revision_t *revs = xmalloc(sizeof(revision_t) * tag->count, __func__);
-    size_t i;
     for (i = 0; i < tag->count; i++)
-	REVISION_T_PACK_INIT(revs[i], revisions[i]);
-    git_commit *g = git_commit_build(revs, c, tag->count);
+	REVISION_T_PACK_INIT(revs[i], ts->revisions[i]);
+    git_commit *g = git_commit_build(packer, revs, c, tag->count);
     free(revs);
     g->parent = c->gitspace;
-    rev_ref *parent_branch = git_branch_of_commit(gl, c);
+    rev_ref *parent_branch = git_branch_of_commit(gi, c);
     rev_ref *tag_branch = xcalloc(1, sizeof(rev_ref), __func__);
     tag_branch->parent = parent_branch;
     /* type punning */
     tag_branch->commit = (cvs_commit *)g;
     tag_branch->ref_name = tag->name;
     tag_branch->depth = parent_branch->depth + 1;
-    rev_ref *r;
     /* Add tag branch to end of list to maintain toposort */
-    for (r = gl->heads; r->next; r = r->next)
-	continue;
-    r->next = tag_branch;
+    (*last)->next = tag_branch;
+    *last = tag_branch;
     g->author = atom("cvs-fast-export");
     size_t len = strlen(tag->name) + 41;
     char *log = xmalloc(len, __func__);
     snprintf(log, len, "Synthetic commit for incomplete tag %s", tag->name);
     g->log = atom(log);
     free(log);
+    gitspace_add_head(gi, tag_branch);
 }
 
 static void
-rev_ref_set_parent(git_repo *gl, rev_ref *dest, cvs_master *source, size_t nmasters)
+rev_ref_set_parent(const branch_index *bi, const branch_name *name)
 /* compute parent relationships among gitspace branches */
 {
-    cvs_master	*s;
-    rev_ref	*p, *max;
+    rev_ref	*dest = name->head, *max;
+    int		i;
 
     if (dest->depth)
 	return;
 
     max = NULL;
-    for (s = source; s < source + nmasters; s++) {
-	rev_ref	*sh;
-	sh = rev_find_head(s, dest->ref_name);
-	if (!sh)
-	    continue;
+    for (i = 0; i < name->nref; i++) {
+	rev_ref		*sh = name->refs[i];
+	branch_name	*p;
 	if (!sh->parent)
 	    continue;
-	p = rev_find_head((head_list*)gl, sh->parent->ref_name);
+	p = branch_index_find(bi, sh->parent->ref_name);
 	assert(p);
-	rev_ref_set_parent(gl, p, source, nmasters);
-	if (!max || p->depth > max->depth)
-	    max = p;
+	rev_ref_set_parent(bi, p);
+	if (!max || p->head->depth > max->depth)
+	    max = p->head;
     }
     dest->parent = max;	/* where the magic happens */
     if (max)
@@ -929,17 +1812,105 @@ rev_ref_set_parent(git_repo *gl, rev_ref *dest, cvs_master *source, size_t nmast
 	dest->depth = 1;
 }
 
+/*
+ * Branch walks are handed out to the --threads pool, largest branch
+ * sets first, with an atomic increment; each walk packs its
+ * snapshots through a revdir chain of its own.
+ */
+static collation *collations;
+static size_t *walk_order;
+static size_t nwalks, next_walk, walked;
+#ifdef THREADS
+static pthread_mutex_t progress_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif /* THREADS */
+
+static int
+collation_size_compare(const void *av, const void *bv)
+/* walk wider branches first, otherwise keep toposorted order */
+{
+    const size_t a = *(const size_t *)av, b = *(const size_t *)bv;
+
+    if (collations[a].nbranch != collations[b].nbranch)
+	return collations[b].nbranch - collations[a].nbranch;
+    return (a > b) - (a < b);
+}
+
+static void
+worker_progress(size_t *done)
+/* count a piece of work done and report the total */
+{
+    __atomic_add_fetch(done, 1, __ATOMIC_RELAXED);
+#ifdef THREADS
+    /*
+     * A worker that can't print right now leaves it to the next.  The
+     * count is read under the lock, so what's printed never goes back.
+     */
+    if (threads > 1) {
+	if (pthread_mutex_trylock(&progress_mutex) == 0) {
+	    progress_jump(__atomic_load_n(done, __ATOMIC_RELAXED));
+	    pthread_mutex_unlock(&progress_mutex);
+	}
+    } else
+#endif /* THREADS */
+	progress_jump(*done);
+}
+
+static void *
+collate_worker(void *arg)
+/* walk gitspace branches until there are none left */
+{
+    for (;;) {
+	size_t k = __atomic_fetch_add(&next_walk, 1, __ATOMIC_RELAXED);
+
+	if (k >= nwalks)
+	    return NULL;
+	collate_branches(&collations[walk_order[k]]);
+	worker_progress(&walked);
+    }
+}
+
+/*
+ * The first pass over the tags is handed out the same way, in tag
+ * order.
+ */
+static tag_search *tag_searches;
+static const gitspace_index *tag_index;
+static size_t next_tag, searched;
+
+static void *
+tag_worker(void *arg)
+/* search for tags' commits until there are none left */
+{
+    for (;;) {
+	size_t k = __atomic_fetch_add(&next_tag, 1, __ATOMIC_RELAXED);
+
+	if (k >= tag_count)
+	    return NULL;
+	rev_tag_search(&tag_searches[k], tag_index);
+	worker_progress(&searched);
+    }
+}
+
 git_repo *
 collate_to_changesets(cvs_master *masters, size_t nmasters, int verbose)
 /* entry point - collate CVS revision lists to a gitspace DAG */
 {
-    size_t	head_count = 0;
-    int		n; /* used only in progress messages */
+    size_t	head_count, i;
     git_repo	*gl = xcalloc(1, sizeof(git_repo), "list collate");
-    cvs_master	*cm;
-    rev_ref	*lh, *h;
+    branch_index branches;
+    gitspace_index gitspace;
+    revdir_packer *packer;
+    rev_ref	*h, *last;
     tag_t	*t;
-    rev_ref	**refs = xcalloc(nmasters, sizeof(rev_ref *), "list collate");
+    int		nsearched;
+#if defined(ORDERDEBUG) || defined(GITSPACEDEBUG)
+    cvs_master	*cm;
+    rev_ref	*lh;
+#endif
+
+    /* before any walk starts fingerprinting */
+    rev_1_1 = atom_cvs_number(lex_number("1.1"));
+    rev_1_1_1_1 = atom_cvs_number(lex_number("1.1.1.1"));
 
     /*
      * It is expected that the branch trees in all CVS masters have
@@ -953,23 +1924,12 @@ collate_to_changesets(cvs_master *masters, size_t nmasters, int verbose)
      *
      * First, find all of the named heads across all of the incoming
      * CVS trees.  Use them to initialize named branch heads in the
-     * output list.  Yes, this is currently very inefficient.
+     * output list, and index each name's CVS branches as we go so
+     * nothing after this has to search the masters again.
      */
     progress_begin("Make DAG branch heads...", nmasters);
-    n = 0;
-    for (cm = masters; cm < masters + nmasters; cm++) {
-	for (lh = cm->heads; lh; lh = lh->next) {
-	    h = rev_find_head((head_list *)gl, lh->ref_name);
-	    if (!h) {
-		head_count++;
-		rev_list_add_head((head_list *)gl, NULL, lh->ref_name, lh->degree);
-	    } else if (lh->degree > h->degree)
-		h->degree = lh->degree;
-	}
-	if (++n % 100 == 0)
-	    progress_jump(n);
-    }
-    progress_jump(n);
+    branch_index_build(&branches, masters, nmasters);
+    head_count = branches.nnames;
     progress_end(NULL);
     /*
      * Sort by degree so that finding branch points always works.
@@ -977,9 +1937,9 @@ collate_to_changesets(cvs_master *masters, size_t nmasters, int verbose)
      * before children, with trunk first.
      */
     progress_begin("Sorting...", nmasters);
-    gl->heads = rev_ref_tsort(gl->heads, masters, nmasters);
+    gl->heads = rev_ref_tsort(&branches);
     if (!gl->heads) {
-	free(refs);
+	branch_index_free(&branches);
 	/* coverity[leaked_storage] */
 	return NULL;
     }
@@ -1000,7 +1960,7 @@ collate_to_changesets(cvs_master *masters, size_t nmasters, int verbose)
      */
     progress_begin("Compute branch parent relationships...", head_count);
     for (h = gl->heads; h; h = h->next) {
-	rev_ref_set_parent(gl, h, masters, nmasters);
+	rev_ref_set_parent(&branches, branch_index_find(&branches, h->ref_name));
 	progress_step();
     }
     progress_end(NULL);
@@ -1022,35 +1982,61 @@ collate_to_changesets(cvs_master *masters, size_t nmasters, int verbose)
      * Collate common branches
      */
 
-    progress_begin("Collate common branches...", head_count);
-    revdir_pack_alloc(nmasters);
-    for (h = gl->heads; h; h = h->next) {
+    collations = xcalloc(head_count, sizeof(collation), "collations");
+    walk_order = xmalloc(head_count * sizeof(size_t), "collations");
+    nwalks = next_walk = walked = 0;
+    for (h = gl->heads, i = 0; h; h = h->next, i++) {
 	/*
-	 * For this imputed gitspace branch, locate the corresponding
-	 * set of CVS branches from every master.
+	 * For this imputed gitspace branch, the index already has the
+	 * corresponding set of CVS branches from every master.
 	 */
-	int nref = 0;
-	for (cm = masters; cm < masters + nmasters; cm++) {
-	    lh = rev_find_head(cm, h->ref_name);
-	    if (lh) {
-		refs[nref++] = lh;
-	    }
-	}
-	if (nref)
-	    /*
-	     * Collate those branches into a single gitspace branch
-	     * and add that to the output revlist on gl.
-	     */
-	    collate_branches(refs, nref, h, gl);
-	progress_step();
+	branch_name *name = branch_index_find(&branches, h->ref_name);
+	collations[i].branch = h;
+	collations[i].branches = name->refs;
+	collations[i].nbranch = name->nref;
+	if (name->nref)
+	    walk_order[nwalks++] = i;
     }
+    qsort(walk_order, nwalks, sizeof(size_t), collation_size_compare);
+
+    progress_begin("Collate common branches...", nwalks);
+    packer = revdir_pack_alloc(nmasters);
+#ifdef THREADS
+    if (threads > 1 && nwalks > 1)
+    {
+	int nworkers = (size_t)threads < nwalks ? threads : (int)nwalks;
+	pthread_t *workers = xcalloc(nworkers, sizeof(pthread_t), __func__);
+	int w;
+
+	for (w = 0; w < nworkers; w++)
+	    pthread_create(&workers[w], NULL, collate_worker, NULL);
+	for (w = 0; w < nworkers; w++)
+	    pthread_join(workers[w], NULL);
+	free(workers);
+    }
+    else
+#endif /* THREADS */
+	collate_worker(NULL);
+    /*
+     * Graft each walked branch onto its parent, and add it to the
+     * output revlist on gl, parents first.
+     */
+    gitspace_index_init(&gitspace);
+    for (i = 0; i < head_count; i++) {
+	if (collations[i].nbranch)
+	    collate_graft(&collations[i], packer, &gitspace);
+	gitspace_add_head(&gitspace, collations[i].branch);
+    }
+    free(collations);
+    free(walk_order);
     progress_end(NULL);
+    branch_index_free(&branches);
 
 
 #ifdef GITSPACEDEBUG
     /* Check every non-dead cvs commit has a backlink
      * and that every pair of linked commits match
-     * according to cvs_commit_match.
+     * according to git_commit_match.
      * (note this will check common parents multiple times)
      */
     for (cm = masters; cm < masters + nmasters; cm++) {
@@ -1063,7 +2049,7 @@ collate_to_changesets(cvs_master *masters, size_t nmasters, int verbose)
 			dump_number_file(LOGFILE, c->master->name, c->number);
 			fprintf(LOGFILE, "\n");
 		    }
-		} else if (!cvs_commit_match(c, (cvs_commit *)c->gitspace)) {
+		} else if (!git_commit_match(c->gitspace, c)) {
 		    fprintf(LOGFILE, "Gitspace doesn't match cvs: ");
 		    dump_number_file(LOGFILE, c->master->name, c->number);
 		    fprintf(LOGFILE, "\n");
@@ -1079,17 +2065,38 @@ collate_to_changesets(cvs_master *masters, size_t nmasters, int verbose)
      * with the right gitspace commit.
      */
     progress_begin("Find tag locations...", tag_count);
-    for (t = all_tags; t; t = t->next) {
-	cvs_commit **commits = tagged(t);
-	if (commits)
-	    rev_tag_search(t, commits, gl);
-	else
-	    announce("internal error - lost tag %s\n", t->name);
-	free(commits);
-	progress_step();
+    /* calloc(0, ...) may return NULL, which xcalloc() takes for no memory */
+    tag_searches = xcalloc(tag_count ? tag_count : 1, sizeof(tag_search),
+			   "tag search");
+    for (t = all_tags, i = 0; t; t = t->next, i++)
+	tag_searches[i].tag = t;
+    tag_index = &gitspace;
+    next_tag = searched = 0;
+#ifdef THREADS
+    if (threads > 1 && tag_count > 1)
+    {
+	int nworkers = (size_t)threads < tag_count ? threads : (int)tag_count;
+	pthread_t *workers = xcalloc(nworkers, sizeof(pthread_t), __func__);
+	int w;
+
+	for (w = 0; w < nworkers; w++)
+	    pthread_create(&workers[w], NULL, tag_worker, NULL);
+	for (w = 0; w < nworkers; w++)
+	    pthread_join(workers[w], NULL);
+	free(workers);
+    }
+    else
+#endif /* THREADS */
+	tag_worker(NULL);
+    for (h = gl->heads; h->next; h = h->next)
+	continue;
+    for (i = 0, last = h, nsearched = gitspace.nheads; i < tag_count; i++) {
+	rev_tag_branch(&tag_searches[i], &last, nsearched, packer, &gitspace);
+	free(tag_searches[i].revisions);
     }
-    revdir_pack_free();
-    revdir_free_bufs();
+    free(tag_searches);
+    revdir_pack_free(packer);
+    gitspace_index_free(&gitspace);
     progress_end(NULL);
 
     /*
@@ -1101,8 +2108,6 @@ collate_to_changesets(cvs_master *masters, size_t nmasters, int verbose)
     rev_list_set_tail((head_list *)gl);
     progress_end(NULL);
 
-    free(refs);
-
     //progress_begin("Validate...", NO_MAX);
     //rev_list_validate(gl);
     //progress_end(NULL);
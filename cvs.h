@@ -13,6 +13,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdarg.h>
 #include <ctype.h>
@@ -23,6 +24,8 @@
 #include <stdbool.h>
 #include <limits.h>
 #include "cvstypes.h"
+#include "arena.h"
+#include "sha1.h"
 /* 
  * CVS_MAX_BRANCHWIDTH should match the number in the longrev test.
  * If it goes above 128 some bitfield widths in rev_ref must increase.
@@ -43,6 +46,15 @@ typedef struct _cvs_number {
     short		n[CVS_MAX_DEPTH];
 } cvs_number;
 
+/*
+ * Interned numbers are allocated only as long as their count needs,
+ * so copy them with cvs_number_copy() rather than by assignment.
+ */
+#define CVS_NUMBER_SIZE(c)	(offsetof(cvs_number, n) + (c) * sizeof(short))
+
+/* revisions this deep or shallower order exactly by cvs_number_pack() */
+#define CVS_PACKED_DEPTH	4
+
 extern const cvs_number cvs_zero;
 
 struct _cvs_version;
@@ -58,6 +70,7 @@ typedef struct node {
     struct node *down;
     struct node *sib;
     const cvs_number *number;
+    uint64_t key;	/* cvs_number_pack() of number */
     flag starts;
 } node_t;
 
@@ -67,6 +80,7 @@ typedef struct nodehash {
     node_t *table[NODE_HASH_SIZE];
     int nentries;
     node_t *head_node;
+    arena_t arena;	/* the nodes and everything they index */
 } nodehash_t;
 
 typedef struct _cvs_symbol {
@@ -104,11 +118,17 @@ typedef struct _cvs_text {
     off_t		offset; /* position of initial '@' */
 } cvs_text;
 
+typedef struct _cvs_log {
+    /* a log message, left in its rcs file until somebody needs it */
+    cvs_text		text;
+    const char		*atom;	/* interned text, NULL until first used */
+} cvs_log;
+
 typedef struct _cvs_patch {
     /* a CVS patch structure */
     struct _cvs_patch	*next;
     const cvs_number	*number;
-    const char		*log;
+    cvs_log		log;
     cvs_text		text;
     node_t		*node;
 } cvs_patch;
@@ -143,7 +163,7 @@ enum expand_mode {EXPANDKKV,	/* default form, $<key>: <value>$ */
 		};
 
 typedef struct _editbuffer {
-    const char *Glog;
+    cvs_log *Glog;
     int Gkvlen;
     char* Gkeyval;
     char const *Gfilename;
@@ -199,7 +219,7 @@ typedef struct _generator {
     enum expand_mode    expand;
     cvs_version		*versions;
     cvs_patch		*patches;
-    nodehash_t		nodehash;
+    nodehash_t		nodehash;	/* owns versions, branches and patches */
     editbuffer_t	editbuffer;
 } generator_t;
 
@@ -207,11 +227,14 @@ typedef struct {
     /* this represents the entire metadata content of a CVS master file */
     const char		*export_name;
     cvs_symbol		*symbols;
+    arena_t		arena;		/* the symbols */
 #ifdef REDBLACK
     struct rbtree_node	*symbols_by_name;
 #endif /* REDBLACK */
     const char		*description;
     generator_t		gen;
+    char		*text;		/* master contents, while scanning */
+    size_t		textsize;
     const cvs_number	*head;
     const cvs_number	*branch;
     cvstime_t           skew_vulnerable;
@@ -297,7 +320,6 @@ typedef struct _revdir {
 typedef struct _cvs_commit {
     /* a CVS revision */
     struct _cvs_commit	*parent;
-    const char		*restrict log;
     const char		*restrict author;
     const char	        *restrict commitid;
     cvstime_t		date;
@@ -309,6 +331,7 @@ typedef struct _cvs_commit {
     /* CVS-only members begin here */
     bool                emitted:1;
     hash_t              hash;
+    cvs_log		*log;		/* points into the master's patch */
     /* Shortcut to master->dir, more space but less dereferences
      * in the hottest inner loop in revdir
      */
@@ -321,7 +344,6 @@ typedef struct _cvs_commit {
 typedef struct _git_commit {
     /* a gitspace changeset */
     struct _git_commit	*parent;
-    const char		*restrict log;
     const char		*restrict author;
     const char		*restrict commitid;
     cvstime_t		date;
@@ -331,7 +353,9 @@ typedef struct _git_commit {
     unsigned		tailed:1;
     unsigned		dead:1;
     /* gitspace-only members begin here. */
+    const char		*restrict log;
     revdir		revdir;
+    uint64_t		fingerprint;	/* of the revision set, see collate.c */
 } git_commit;
 
 typedef struct _rev_ref {
@@ -479,6 +503,8 @@ typedef struct _tag {
 	git_commit *commit;
 	rev_ref *parent;
 	const char *last;
+	const rev_master *first;	/* earliest master in path order to use it */
+	int serial;			/* its position among that master's tags */
 } tag_t;
 
 typedef struct _forest {
@@ -496,7 +522,8 @@ extern tag_t  *all_tags;
 extern size_t tag_count;
 extern const master_dir *root_dir;
 
-void tag_commit(cvs_commit *c, const char *name, cvs_file *cvsfile);
+void tag_commit(cvs_commit *c, const char *name, cvs_file *cvsfile, int serial);
+void sort_tags(void);
 cvs_commit **tagged(tag_t *tag);
 void discard_tags(void);
 
@@ -504,8 +531,19 @@ typedef struct _import_options {
     bool promiscuous;
     int verbose;
     ssize_t striplen;
+    const char *parse_cache;	/* directory, or NULL */
+    bool early_blobs;		/* write snapshots during analysis */
 } import_options_t;
 
+typedef struct _master_stat {
+    /* what the parse cache checks a master against */
+    off_t	size;
+    time_t	mtime;
+    long	mtime_nsec;
+    ino_t	ino;
+    mode_t	mode;
+} master_stat;
+
 typedef struct _export_options {
     struct timespec start_time;
     char *branch_prefix; 
@@ -516,16 +554,28 @@ typedef struct _export_options {
     bool force_dates;
     bool authorlist;
     bool progress;
+    bool dedup_blobs;
 } export_options_t;
 
 typedef struct _export_stats {
     long	export_total_commits;
     double	snapsize;
+    long	dedup_hits;	/* snapshots not spooled, content seen before */
+    double	dedup_bytes;
+    long	dedup_marks;	/* blobs not emitted, content already sent */
 } export_stats_t;
 
 void
 analyze_masters(int argc, const char *argv[0], import_options_t *options, forest_t *forest);
 
+bool
+parsecache_load(const char *dir, const char *name,
+		const master_stat *st, cvs_file *cvs);
+
+void
+parsecache_save(const char *dir, const char *name,
+		const master_stat *st, const cvs_file *cvs);
+
 enum expand_mode expand_override(char const *s);
 
 bool
@@ -537,6 +587,12 @@ cvs_same_branch(const cvs_number *a, const cvs_number *b);
 bool
 cvs_number_equal(const cvs_number *n1, const cvs_number *n2);
 
+void
+cvs_number_copy(cvs_number *dst, const cvs_number *src);
+
+uint64_t
+cvs_number_pack(const cvs_number *n);
+
 int
 cvs_number_compare(const cvs_number *a, const cvs_number *b);
 
@@ -570,6 +626,15 @@ cvs_is_trunk(const cvs_number *number);
 bool
 cvs_is_vendor(const cvs_number *number);
 
+const char *
+cvs_log_atom(cvs_log *log);
+
+void
+cvs_master_logs(const rev_master *master);
+
+const char *
+cvs_commit_log(const cvs_commit *commit);
+
 void
 cvs_file_free(cvs_file *cvs);
 
@@ -610,9 +675,15 @@ atom(const char *string);
 const cvs_number *
 atom_cvs_number(const cvs_number n);
 
+serial_t
+atom_blob(const uint8_t id[SHA1_SIZE], serial_t serial);
+
 unsigned long
 hash_cvs_number(const cvs_number *const key);
 
+void
+atom_stats(FILE *fp);
+
 void
 discard_atoms(void);
 
@@ -636,6 +707,15 @@ path_deep_compare(const void *a, const void *b);
 
 #define time_compare(a,b) ((long)(a) - (long)(b))
 
+void
+export_blobs_begin(const export_options_t *opts);
+
+void
+export_blobs_early(generator_t *gen);
+
+void
+export_blobs_end(void);
+
 void
 export_commits(forest_t *forest, export_options_t *opts, export_stats_t *stats);
 
@@ -645,9 +725,13 @@ export_authors(forest_t *forest, export_options_t *opts);
 void
 free_author_map(void);
 
+serial_t
+generator_blobs(const generator_t *gen);
+
 void
-generate_files(generator_t *gen, export_options_t *opts,
-	       void (*hook)(node_t *node, void *buf, size_t len, export_options_t *popts));
+generate_files(generator_t *gen, serial_t serial, export_options_t *opts,
+	       void (*hook)(node_t *node, serial_t serial,
+			    void *buf, size_t len, export_options_t *popts));
 
 /* xnew(T) allocates aligned (packed) storage. It never returns NULL */
 #define xnew(T, legend) \
@@ -29,12 +29,12 @@ cvs_same_branch(const cvs_number *a, const cvs_number *b)
     int		n;
 
     if (a->c & 1) {
-	t = *a;
+	cvs_number_copy(&t, a);
 	t.n[t.c++] = 0;
 	return cvs_same_branch(&t, b);
     }
     if (b->c & 1) {
-	t = *b;
+	cvs_number_copy(&t, b);
 	t.n[t.c++] = 0;
 	return cvs_same_branch(a, &t);
     }
@@ -63,10 +63,35 @@ cvs_same_branch(const cvs_number *a, const cvs_number *b)
     return true;
 }
 
+void
+cvs_number_copy(cvs_number *dst, const cvs_number *src)
+/* copy a revision number; interned ones are only as long as they need */
+{
+    memcpy(dst, src, CVS_NUMBER_SIZE(src->c));
+}
+
+uint64_t
+cvs_number_pack(const cvs_number *n)
+/* pack the leading components into a key that orders like they do */
+{
+    uint64_t key = 0;
+    int i;
+
+    /* bias each short so that unsigned order matches signed order */
+    for (i = 0; i < CVS_PACKED_DEPTH; i++)
+	key = key << 16 | (i < n->c ? (uint16_t)n->n[i] ^ 0x8000 : 0);
+    return key;
+}
+
 bool
 cvs_number_equal(const cvs_number *n1, const cvs_number *n2) {
+    /* interned numbers are equal only if they're the same atom */
+    if (n1 == n2)
+	return true;
+    if (n1->c != n2->c)
+	return false;
     /* can use memcmp as cvs_number isn't padded */
-    return 0 == memcmp(n1, n2, sizeof(short) * (n1->c + 1));
+    return 0 == memcmp(n1->n, n2->n, sizeof(short) * n1->c);
     /*
     if (n1->n != n2->n)
 	return false;
@@ -86,6 +111,8 @@ cvs_number_compare(const cvs_number *a, const cvs_number *b)
     int n = min(a->c, b->c);
     int i;
 
+    if (a == b)
+	return 0;
     /*
      * On the same branch, earlier commits compare before later ones.
      * On different ranches of the same degree, the earlier one
@@ -123,7 +150,7 @@ cvs_number_degree(const cvs_number *n)
 
     if (n->c < 4)
 	return n->c;
-    four = *n;
+    cvs_number_copy(&four, n);
     four.c = 4;
     /*
      * Place vendor branch between trunk and other branches
@@ -5,74 +5,157 @@
  */
 
 #include <assert.h>
+#include <fcntl.h>
+#ifdef USE_MMAP
+#include <sys/mman.h>
+#endif /* USE_MMAP */
 
 #ifdef REDBLACK
 #include "rbtree.h"
 #endif /* REDBLACK */
 #include "cvs.h"
+#include "atscan.h"
 
-static void
-cvs_symbol_free(cvs_symbol *symbol)
-/* discard all master symbols from this CVS context */
+void
+generator_free(generator_t *gen)
 {
-    cvs_symbol	*s;
+    clean_hash(&gen->nodehash);
+}
 
-    while ((s = symbol)) {
-	symbol = s->next;
-	free(s);
-    }
+static const char *
+log_intern(cvs_log *log, char *at)
+/* unescape a log's @-string where it was read in, and intern it */
+{
+    const cvs_text *text = &log->text;
+    const char *found;
+
+    if (at[0] != '@' || at[text->length - 1] != '@')
+	fatal_error("%s: log at offset %lld is not an @-string",
+		    text->filename, (long long)text->offset);
+    atunescape(at, at, text->length);
+    found = atom(at);
+    __atomic_store_n(&log->atom, found, __ATOMIC_RELEASE);
+    return found;
 }
 
 static void
-cvs_branch_free(cvs_branch *branch)
-/* discard all master branches from this CVS context */
+read_span(const int fd, const char *filename, char *buf, size_t len,
+	  off_t offset)
 {
-    cvs_branch	*b;
+    size_t got = 0;
 
-    while ((b = branch)) {
-	branch = b->next;
-	free(b);
+    while (got < len) {
+	ssize_t n = pread(fd, buf + got, len - got, offset + got);
+	if (n <= 0)
+	    fatal_system_error("%s: reading log", filename);
+	got += n;
     }
 }
 
-static void
-cvs_version_free(cvs_version *version)
-/* discard all master versions from this CVS context */
+const char *
+cvs_log_atom(cvs_log *log)
+/* intern a log message, fetching it from its master the first time */
 {
-    cvs_version	*v;
+    const cvs_text *text;
+    const char *found;
+    char *buf;
+    int fd;
 
-    while ((v = version)) {
-	version = v->next;
-	cvs_branch_free(v->branches);
-	free(v);
-    }
+    if (log == NULL)
+	return NULL;	/* a revision with no deltatext */
+    /* collation threads may race to fetch a log; both get the same atom */
+    if ((found = __atomic_load_n(&log->atom, __ATOMIC_ACQUIRE)) != NULL)
+	return found;
+
+    text = &log->text;
+    if ((fd = open(text->filename, O_RDONLY)) == -1)
+	fatal_system_error("open: %s", text->filename);
+    buf = xmalloc(text->length + 1, "log message");
+    read_span(fd, text->filename, buf, text->length, text->offset);
+    close(fd);
+    found = log_intern(log, buf);
+    free(buf);
+    return found;
 }
 
-static void
-cvs_patch_free(cvs_patch *patch)
-/* discard all master patches from this CVS context */
+void
+cvs_master_logs(const rev_master *master)
+/* intern every log of a master not yet interned, reading it just once */
 {
-    cvs_patch	*v;
+    const char *filename = NULL;
+    off_t lo = 0, hi = 0;
+    char *span;
+    serial_t i;
+    int fd;
+#ifdef USE_MMAP
+    off_t base;
+#endif /* USE_MMAP */
+
+    for (i = 0; i < master->ncommits; i++) {
+	const cvs_log *log = master->commits[i].log;
 
-    while ((v = patch)) {
-	patch = v->next;
-	free(v);
+	if (log == NULL || __atomic_load_n(&log->atom, __ATOMIC_ACQUIRE))
+	    continue;
+	if (filename == NULL || log->text.offset < lo)
+	    lo = log->text.offset;
+	if (filename == NULL || log->text.offset + (off_t)log->text.length > hi)
+	    hi = log->text.offset + (off_t)log->text.length;
+	filename = log->text.filename;
     }
+    if (filename == NULL)
+	return;
+
+    /*
+     * Logs sit between the delta texts, so read from the first to the
+     * end of the last in one go.  Each is unescaped where it lies,
+     * which never writes past its own closing @.
+     */
+    if ((fd = open(filename, O_RDONLY)) == -1)
+	fatal_system_error("open: %s", filename);
+#ifdef USE_MMAP
+    base = lo - lo % (off_t)sysconf(_SC_PAGESIZE);
+    span = mmap(NULL, hi - base, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, base);
+    if (span == MAP_FAILED)
+	fatal_system_error("mmap: %s", filename);
+    span += lo - base;
+#else
+    span = xmalloc(hi - lo, "log messages");
+    read_span(fd, filename, span, hi - lo, lo);
+#endif /* USE_MMAP */
+    close(fd);
+
+    for (i = 0; i < master->ncommits; i++) {
+	cvs_log *log = master->commits[i].log;
+
+	if (log != NULL && !__atomic_load_n(&log->atom, __ATOMIC_ACQUIRE))
+	    log_intern(log, span + (log->text.offset - lo));
+    }
+#ifdef USE_MMAP
+    munmap(span - (lo - base), hi - base);
+#else
+    free(span);
+#endif /* USE_MMAP */
 }
 
-void
-generator_free(generator_t *gen)
+const char *
+cvs_commit_log(const cvs_commit *commit)
+/* a revision's interned log message, reading in its master's on a miss */
 {
-    cvs_version_free(gen->versions);
-    cvs_patch_free(gen->patches);
-    clean_hash(&gen->nodehash);
+    const char *found;
+
+    if (commit->log == NULL)
+	return NULL;
+    if ((found = __atomic_load_n(&commit->log->atom, __ATOMIC_ACQUIRE)) != NULL)
+	return found;
+    cvs_master_logs(commit->master);
+    return __atomic_load_n(&commit->log->atom, __ATOMIC_ACQUIRE);
 }
 
 void
 cvs_file_free(cvs_file *cvs)
 /* discard a file object and its storage */
 {
-    cvs_symbol_free(cvs->symbols);
+    arena_free(&cvs->arena);
 #ifdef REDBLACK
     rbtree_free(cvs->symbols_by_name);
 #endif /* REDBLACK */
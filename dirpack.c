@@ -33,49 +33,75 @@ hash_files(const cvs_commit *const * const files, const int nfiles)
     return h;
 }
 
+static file_list_hash *
+file_list_find(file_list_hash *h, const hash_t hash,
+	       const cvs_commit * const * const files, const int nfiles)
+/* look along a hash chain for a file list */
+{
+    for (; h; h = h->next)
+	if (h->hash == hash && h->fl.nfiles == nfiles &&
+	    !memcmp(files, h->fl.files, nfiles * sizeof(cvs_commit *)))
+	    return h;
+    return NULL;
+}
+
 static file_list *
 pack_file_list(const cvs_commit * const * const files, const int nfiles)
 /* pack a collection of file revisions for space efficiency */
 {
     hash_t         hash = hash_files(files, nfiles);
-    file_list_hash **bucket = &buckets[hash % REV_DIR_HASH];
+    const size_t   slot = hash % REV_DIR_HASH;
+    file_list_hash **bucket = &buckets[slot];
     file_list_hash *h;
 
     /* avoid packing a file list if we've done it before */ 
-    for (h = *bucket; h; h = h->next) {
-	if (h->hash == hash && h->fl.nfiles == nfiles &&
-	    !memcmp(files, h->fl.files, nfiles * sizeof(cvs_commit *)))
-	{
-	    return &h->fl;
-	}
+    h = file_list_find(__atomic_load_n(bucket, __ATOMIC_ACQUIRE),
+		       hash, files, nfiles);
+    if (h)
+	return &h->fl;
+    pack_lock(slot);
+    /* another thread may have packed the same thing since we looked */
+    h = file_list_find(*bucket, hash, files, nfiles);
+    if (!h) {
+	h = xmalloc(sizeof(file_list_hash) + nfiles * sizeof(cvs_commit *),
+		    __func__);
+	h->next = *bucket;
+	h->hash = hash;
+	h->fl.nfiles = nfiles;
+	memcpy(h->fl.files, files, nfiles * sizeof(cvs_commit *));
+	__atomic_store_n(bucket, h, __ATOMIC_RELEASE);
     }
-    h = xmalloc(sizeof(file_list_hash) + nfiles * sizeof(cvs_commit *),
-		 __func__);
-    h->next = *bucket;
-    *bucket = h;
-    h->hash = hash;
-    h->fl.nfiles = nfiles;
-    memcpy(h->fl.files, files, nfiles * sizeof(cvs_commit *));
+    pack_unlock(slot);
     return &h->fl;
 }
 
-static size_t    sdirs = 0;
-static file_list **dirs = NULL;
+/* state of one streaming pack; each packing thread has its own */
+struct _revdir_packer {
+    serial_t		nfiles;
+    serial_t		sfiles;
+    const cvs_commit	**files;
+    const master_dir	*dir;
+    const master_dir	*curdir;
+    unsigned short	ndirs;
+    size_t		sdirs;
+    file_list		**dirs;
+};
 
 static void
-fl_put(const size_t index, file_list *fl)
+fl_put(revdir_packer *p, const size_t index, file_list *fl)
 /* puts an entry into the dirs buffer, growing if needed */
 {
-    if (sdirs == 0) {
-	sdirs = 128;
-	dirs = xmalloc(sdirs * sizeof(file_list *), __func__);
-    } else if (sdirs <= index) {
+    if (p->sdirs == 0) {
+	p->sdirs = 128;
+	p->dirs = xmalloc(p->sdirs * sizeof(file_list *), __func__);
+    }
+    if (p->sdirs <= index) {
 	do {
-	    sdirs *= 2;
-	} while (sdirs <= index);
-	dirs = xrealloc(dirs, sdirs * sizeof(revdir *), __func__);
+	    p->sdirs *= 2;
+	} while (p->sdirs <= index);
+	p->dirs = xrealloc(p->dirs, p->sdirs * sizeof(revdir *), __func__);
     }
-    dirs[index] = fl;
+    p->dirs[index] = fl;
 }
 
 void
@@ -93,16 +119,6 @@ revdir_free(void)
     }
 }
 
-void
-revdir_free_bufs(void)
-{
-    if (dirs) {
-	free(dirs);
-	dirs = NULL;
-	sdirs = 0;
-    }
-}
-
 struct _revdir_iter {
     file_list * const *dir;
     file_list * const *dirmax;
@@ -174,70 +190,111 @@ revdir_nfiles(const revdir *revdir)
     return c;
 }
 
-static serial_t         nfiles = 0;
-static serial_t         sfiles = 0;
-static const cvs_commit **files = NULL;
-static const master_dir *dir;
-static const master_dir *curdir;
-static unsigned short   ndirs;
-
-void
+revdir_packer *
 revdir_pack_alloc(const size_t max_size)
 {
-    if (!files) {
-	files = xmalloc(max_size * sizeof(cvs_commit *), __func__);
-	sfiles = max_size;
-    } else if (sfiles < max_size) {
-	files = xrealloc(files, max_size * sizeof(cvs_commit *), __func__);
-	sfiles = max_size;
-    }
+    revdir_packer *p = xcalloc(1, sizeof(revdir_packer), __func__);
+
+    p->files = xmalloc(max_size * sizeof(cvs_commit *), __func__);
+    p->sfiles = max_size;
+    return p;
 }
 
 void
-revdir_pack_init(void)
+revdir_pack_init(revdir_packer *p)
 {
-    nfiles = 0;
-    curdir = NULL;
-    dir = NULL;
-    ndirs = 0;
+    p->nfiles = 0;
+    p->curdir = NULL;
+    p->dir = NULL;
+    p->ndirs = 0;
 }
 
 void
-revdir_pack_add(const cvs_commit *file, const master_dir *in_dir)
+revdir_pack_add(revdir_packer *p, const cvs_commit *file, const master_dir *in_dir)
 {
-    if (curdir != in_dir) {
-	if (!dir_is_ancestor(in_dir, dir)) {
-	    if (nfiles > 0) {
-		file_list *fl = pack_file_list(files, nfiles);
-		fl_put(ndirs++, fl);
-		nfiles = 0;
+    if (p->curdir != in_dir) {
+	if (!dir_is_ancestor(in_dir, p->dir)) {
+	    if (p->nfiles > 0) {
+		file_list *fl = pack_file_list(p->files, p->nfiles);
+		fl_put(p, p->ndirs++, fl);
+		p->nfiles = 0;
 	    }
-	    dir = in_dir;
+	    p->dir = in_dir;
 	}
-	curdir = in_dir;
+	p->curdir = in_dir;
     }
-    files[nfiles++] = file;
+    p->files[p->nfiles++] = file;
 }
 
 void
-revdir_pack_end(revdir *revdir)
+revdir_pack_end(revdir_packer *p, revdir *revdir)
 {
-    if (dir) {
-	file_list *fl = pack_file_list(files, nfiles);
-	fl_put(ndirs++, fl);
+    if (p->dir) {
+	file_list *fl = pack_file_list(p->files, p->nfiles);
+	fl_put(p, p->ndirs++, fl);
     }
-    revdir->dirs = xmalloc(ndirs * sizeof(file_list *), __func__);
-    revdir->ndirs = ndirs;
-    memcpy(revdir->dirs, dirs, ndirs * sizeof(file_list *));
+    revdir->dirs = xmalloc(p->ndirs * sizeof(file_list *), __func__);
+    revdir->ndirs = p->ndirs;
+    memcpy(revdir->dirs, p->dirs, p->ndirs * sizeof(file_list *));
+}
+
+void
+revdir_pack_free(revdir_packer *p)
+{
+    free(p->files);
+    free(p->dirs);
+    free(p);
+}
+
+/*
+ * Chains pack the whole slot set every time; dirpack has no tree to
+ * share unchanged directories through.
+ */
+struct _revdir_chain {
+    revdir_packer	*packer;
+    size_t		nslots;
+    const master_dir	**dirs;
+    const cvs_commit	**slots;
+};
+
+revdir_chain *
+revdir_chain_alloc(const master_dir **dirs, const size_t nslots)
+{
+    revdir_chain *chain = xmalloc(sizeof(revdir_chain), __func__);
+
+    chain->packer = revdir_pack_alloc(nslots);
+    chain->nslots = nslots;
+    chain->dirs = xmalloc((nslots ? nslots : 1) * sizeof(master_dir *), __func__);
+    memcpy(chain->dirs, dirs, nslots * sizeof(master_dir *));
+    chain->slots = xcalloc(nslots ? nslots : 1, sizeof(cvs_commit *), __func__);
+    return chain;
+}
+
+void
+revdir_chain_set(revdir_chain *chain, const size_t slot, const cvs_commit *file)
+{
+    chain->slots[slot] = file;
+}
+
+void
+revdir_chain_pack(revdir_chain *chain, revdir *revdir)
+{
+    size_t i;
+
+    revdir_pack_init(chain->packer);
+    for (i = 0; i < chain->nslots; i++)
+	if (chain->slots[i])
+	    revdir_pack_add(chain->packer, chain->slots[i], chain->dirs[i]);
+    revdir_pack_end(chain->packer, revdir);
 }
 
 void
-revdir_pack_free()
+revdir_chain_free(revdir_chain *chain)
 {
-    free(files);
-    files = NULL;
-    nfiles = 0;
-    sfiles = 0;
+    revdir_pack_free(chain->packer);
+    free(chain->dirs);
+    free(chain->slots);
+    free(chain);
 }
 
 void
@@ -248,6 +305,7 @@ revdir_pack_files(const cvs_commit ** files,
     const master_dir *tdir = NULL, *adir = NULL;
     file_list        *fl;
     unsigned short   countdirs = 0;
+    revdir_packer    p = {0};
 #ifdef ORDERDEBUG
     fputs("Packing:\n", stderr);
     {
@@ -274,7 +332,7 @@ revdir_pack_files(const cvs_commit ** files,
 	    if (!dir_is_ancestor(files[i]->dir, adir)) {
 		if (i > start) {
 		    fl = pack_file_list(files + start, i - start);
-		    fl_put(countdirs++, fl);
+		    fl_put(&p, countdirs++, fl);
 		    start = i;
 		}
 		adir = files[i]->dir;
@@ -282,12 +340,13 @@ revdir_pack_files(const cvs_commit ** files,
 	    tdir = files[i]->dir;
 	}
     }
-    if (dir) {
+    if (adir) {
         fl = pack_file_list(files + start, nfiles - start);
-        fl_put(countdirs++, fl);
+        fl_put(&p, countdirs++, fl);
     }
     
     revdir->dirs = xmalloc(countdirs * sizeof(file_list *), "rev_dir");
     revdir->ndirs = countdirs;
-    memcpy(revdir->dirs, dirs, countdirs * sizeof(file_list *));
+    memcpy(revdir->dirs, p.dirs, countdirs * sizeof(file_list *));
+    free(p.dirs);
 }
@@ -53,10 +53,8 @@
  * timestamps from RCS and SCCS - those fossils have been seen in the
  * wild, notably in the histories of GCC and Emacs.
  *
- * If you see this error with -t 0, report it as a bug.  It might mean
- * we have to bite the bullet and implement a real toposort here, or it 
- * might just mean some timestamps in your masters need to be patched
- * by a few seconds.
+ * canonicalize() now never places a commit before its parent, so
+ * this error should be impossible.  If you see it, report it as a bug.
  */
 
 #define _XOPEN_SOURCE 700
@@ -66,8 +64,18 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <sys/types.h>
-#include <ftw.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif /* __linux__ */
+#ifdef USE_MMAP
+#include <sys/mman.h>
+#endif /* USE_MMAP */
+#include <unistd.h>
 #include <time.h>
+#ifdef THREADS
+#include <pthread.h>
+#endif /* THREADS */
 
 #include "cvs.h"
 #include "revdir.h"
@@ -91,20 +99,17 @@
 static serial_t *markmap;
 static serial_t mark;
 static volatile int seqno;
-static char blobdir[PATH_MAX];
+static size_t snapbytes;
 
-static export_stats_t export_stats;
-
-static int seqno_next(void)
-/* Returns next sequence number, starting with 1 */
-{
-    ++seqno;
-
-    if (seqno >= MAX_SERIAL_T)
-	fatal_error("snapshot sequence number too large, widen serial_t");
+/* snapshot generation work, shared by the threads doing it */
+static generator_t *generators;
+static serial_t *first_serial;
+static size_t next_generator, ngenerators, generated;
+#ifdef THREADS
+static pthread_mutex_t progress_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif /* THREADS */
 
-    return seqno;
-}
+static export_stats_t export_stats;
 
 /*
  * GNU CVS default ignores.  We omit from this things that CVS ignores
@@ -114,74 +119,78 @@ static int seqno_next(void)
  */
 #define CVS_IGNORES "# CVS default ignores begin\ntags\nTAGS\n.make.state\n.nse_depinfo\n*~\n\\#*\n.#*\n,*\n_$*\n*$\n*.old\n*.bak\n*.BAK\n*.orig\n*.rej\n.del-*\n*.a\n*.olb\n*.o\n*.obj\n*.so\n*.exe\n*.Z\n*.elc\n*.ln\ncore\n# CVS default ignores end\n"
 
-static char *blobfile(const char *basename,
-		      const int serial,
-		      const bool create, char *path)
-/* Random-access location of the blob corresponding to the specified serial */
+/*
+ * Blobs go into one spool file, appended in whatever order they are
+ * generated and found again through an index by serial.  Writers
+ * reserve their extent with an atomic add on the spool size and then
+ * pwrite() it, so threads never wait on each other here.  The spool is
+ * unlinked as soon as it has been created; closing it is all the
+ * cleanup there is, and nothing is left behind if we die.
+ *
+ * The index is allocated in chunks as serials turn up, because with
+ * --early-blobs the number of snapshots isn't known in advance.
+ *
+ * With --dedup-blobs each snapshot is hashed the way git would name
+ * it.  A snapshot whose content has been seen before isn't spooled;
+ * its extent just names the serial that was, and the first of them to
+ * be exported leaves its mark there for the others to reuse.
+ */
+#define EXTENT_SHIFT	16
+#define EXTENT_CHUNK	(1 << EXTENT_SHIFT)
+
+typedef struct _blob_extent {
+    off_t	offset;
+    size_t	length;		/* 0 if the blob was never written */
+    serial_t	same;		/* nonzero if another serial holds the content */
+    serial_t	mark;		/* mark under which the content went out */
+} blob_extent;
+
+static int spool = -1;
+static off_t spool_size;
+static bool dedup;
+static size_t dedup_hits, dedup_bytes;
+static blob_extent *extents[((size_t)MAX_SERIAL_T >> EXTENT_SHIFT) + 1];
+
+static blob_extent *blob_extent_slot(const serial_t serial, const bool create)
+/* where the spool location of the specified serial is kept */
 {
-    int m;
-
-#ifdef FDEBUG
-    (void)fprintf(stderr, "-> blobfile(%d, %d)...\n", serial, create);
-#endif /* FDEBUG */
-    (void)snprintf(path, PATH_MAX, "%s", blobdir);
-    /*
-     * FANOUT should be chosen to be the largest directory size that does not
-     * cause slow secondary allocations.  It's something near 256 on ext4
-     * (we think...)
-     */
-#define FANOUT	256
-    for (m = serial;;)
-    {
-	int digit = m % FANOUT;
-	if ((m = (m - digit) / FANOUT) == 0) {
-	    (void)snprintf(path + strlen(path), PATH_MAX - strlen(path),
-			   "/=%x", digit);
-#ifdef FDEBUG
-	    (void)fprintf(stderr, "path: %s\n", path);
-#endif /* FDEBUG */
-	    break;
-	}
+    blob_extent **chunk = &extents[serial >> EXTENT_SHIFT];
+    blob_extent *found = __atomic_load_n(chunk, __ATOMIC_ACQUIRE);
+
+    if (found == NULL) {
+	blob_extent *fresh;
+
+	if (!create)
+	    return NULL;
+	fresh = xcalloc(EXTENT_CHUNK, sizeof(blob_extent), "blob index");
+	if (__atomic_compare_exchange_n(chunk, &found, fresh, false,
+					__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+	    found = fresh;
 	else
-	{
-	    (void)snprintf(path + strlen(path), PATH_MAX - strlen(path),
-			   "/%x", digit);
-	    /* coverity[toctou] */
-#ifdef FDEBUG
-	    (void)fprintf(stderr, "directory: %s\n", path);
-#endif /* FDEBUG */
-	    if (create && access(path, R_OK) != 0) {
-#ifdef FDEBUG
-		(void)fprintf(stderr, "directory: %s\n", path);
-#endif /* FDEBUG */
-		errno = 0;
-		if (mkdir(path,S_IRWXU | S_IRWXG) != 0 && errno != EEXIST)
-		    fatal_error("blob subdir creation of %s failed: %s (%d)\n", path, strerror(errno), errno);
-	    }
-	}
+	    free(fresh);	/* another thread got there first */
     }
-#undef FANOUT
-#ifdef FDEBUG
-    (void)fprintf(stderr, "<- ...returned path for %s %d = %s\n",
-		  basename, serial, path);
-#endif /* FDEBUG */
-    return path;
+    return &found[serial & (EXTENT_CHUNK - 1)];
 }
 
-static void export_blob(node_t *node, 
+static void export_blob(node_t *node, serial_t serial,
 			void *buf, const size_t len,
 			export_options_t *opts)
 /* output the blob, or save where it will be available for random access */
 {
-    size_t extralen = 0;
+    char header[32];
+    struct iovec iov[4];
+    int niov = 0;
+    size_t extralen = 0, total = 0;
+    blob_extent *extent;
+    off_t offset;
 
-    export_stats.snapsize += len;
+    __atomic_fetch_add(&snapbytes, len, __ATOMIC_RELAXED);
 
     if (!noignores && strcmp(node->commit->master->name, ".cvsignore") == 0) {
 	extralen = sizeof(CVS_IGNORES) - 1;
     }
 
-    node->commit->serial = seqno_next();
+    node->commit->serial = serial;
 
     /*
      * FIXME: Someday, avoid this I/O when incremental-dumping.  For
@@ -189,38 +198,295 @@ static void export_blob(node_t *node,
      * node->commit->date fails - emits too few blobs - but only
      * if the -T option is not used. See test/badincr.sh
      */
-    char path[PATH_MAX];
-    FILE *wfp;
-    blobfile(node->commit->master->name, node->commit->serial, true, path);
-    wfp = fopen(path, "w");
-
-    if (wfp == NULL)
-	fatal_error("blobfile open of %s: %s (%d)", 
-		    path, strerror(errno), errno);
-    else {
-	fprintf(wfp, "data %lu\n", (unsigned long)(len + extralen));
+    iov[niov].iov_base = header;
+    iov[niov++].iov_len = snprintf(header, sizeof(header), "data %lu\n",
+				   (unsigned long)(len + extralen));
+    if (extralen > 0) {
+	iov[niov].iov_base = CVS_IGNORES;
+	iov[niov++].iov_len = extralen;
+    }
+    iov[niov].iov_base = buf;
+    iov[niov++].iov_len = len;
+    iov[niov].iov_base = "\n";
+    iov[niov++].iov_len = 1;
+    for (int i = 0; i < niov; i++)
+	total += iov[i].iov_len;
+
+    if (dedup) {
+	char prefix[32];
+	uint8_t id[SHA1_SIZE];
+	sha1_ctx ctx;
+	serial_t first;
+
+	/* git's blob id: hash of "blob <size>\0" and the content */
+	sha1_init(&ctx);
+	sha1_update(&ctx, prefix, snprintf(prefix, sizeof(prefix), "blob %lu",
+					   (unsigned long)(len + extralen)) + 1);
 	if (extralen > 0)
-	    fwrite(CVS_IGNORES, extralen, sizeof(char), wfp);
-	fwrite(buf, len, sizeof(char), wfp);
-	fputc('\n', wfp);
-	(void)fclose(wfp);
+	    sha1_update(&ctx, CVS_IGNORES, extralen);
+	sha1_update(&ctx, buf, len);
+	sha1_final(&ctx, id);
+	if ((first = atom_blob(id, serial)) != serial) {
+	    extent = blob_extent_slot(serial, true);
+	    extent->same = first;
+	    extent->length = total;
+	    __atomic_fetch_add(&dedup_hits, 1, __ATOMIC_RELAXED);
+	    __atomic_fetch_add(&dedup_bytes, total, __ATOMIC_RELAXED);
+	    return;
+	}
+    }
+
+    offset = __atomic_fetch_add(&spool_size, (off_t)total, __ATOMIC_RELAXED);
+    extent = blob_extent_slot(serial, true);
+    extent->offset = offset;
+    extent->length = total;
+
+    while (total > 0) {
+	ssize_t n = pwritev(spool, iov, niov, offset);
+
+	if (n <= 0)
+	    fatal_system_error("writing blob spool");
+	total -= n;
+	offset += n;
+	/* short write: step past what went out */
+	while (n > 0 && (size_t)n >= iov[0].iov_len) {
+	    n -= iov[0].iov_len;
+	    memmove(iov, iov + 1, --niov * sizeof(struct iovec));
+	}
+	if (n > 0) {
+	    iov[0].iov_base = (char *)iov[0].iov_base + n;
+	    iov[0].iov_len -= n;
+	}
     }
 }
 
-static int unlink_cb(const char *fpath, 
-		     const struct stat *sb, int typeflag, struct FTW *ftwbuf)
+static blob_extent *blob_content(const serial_t serial)
+/* where the content of the specified serial is, NULL if it was never written */
 {
-    int rv = remove(fpath);
+    blob_extent *extent = blob_extent_slot(serial, false);
+
+    if (extent == NULL || extent->length == 0)
+	return NULL;
+    if (extent->same != 0)
+	extent = blob_extent_slot(extent->same, false);
+    return extent;
+}
+
+/*
+ * Blobs at least this big skip stdio on the way out.  Below it the
+ * extra flush and system call per blob cost more than the copy saves.
+ */
+#ifndef ZERO_COPY_MIN
+#define ZERO_COPY_MIN	32768
+#endif /* ZERO_COPY_MIN */
+
+#ifdef __linux__
+static bool use_sendfile = true;	/* until the kernel says otherwise */
+#endif /* __linux__ */
 
-    if (rv)
-        perror(fpath);
+static bool send_blob(off_t offset, size_t left)
+/* move a blob from the spool to stdout without copying it through us */
+{
+    /*
+     * Whatever stdio holds - the blob and mark lines, and everything
+     * before them - has to go out first.  The blob's own data line
+     * is in the spool and travels with its content.
+     */
+    if (fflush(stdout) != 0)
+	fatal_system_error("writing export stream");
+#ifdef __linux__
+    while (use_sendfile && left > 0) {
+	ssize_t n = sendfile(STDOUT_FILENO, spool, &offset, left);
+
+	if (n <= 0) {
+	    if (n < 0 && (errno == EINVAL || errno == ENOSYS)) {
+		use_sendfile = false;
+		break;
+	    }
+	    fatal_system_error("sending blob");
+	}
+	left -= n;
+    }
+    if (left == 0)
+	return true;
+#endif /* __linux__ */
+#ifdef USE_MMAP
+    {
+	/* one write straight out of the page cache */
+	size_t pagesize = (size_t)sysconf(_SC_PAGESIZE);
+	off_t base = offset - offset % pagesize;
+	size_t span = left + (offset - base);
+	char *map = mmap(NULL, span, PROT_READ, MAP_SHARED, spool, base);
+
+	if (map != MAP_FAILED) {
+	    char *p = map + (offset - base);
+
+	    while (left > 0) {
+		ssize_t n = write(STDOUT_FILENO, p, left);
+
+		if (n <= 0)
+		    fatal_system_error("writing export stream");
+		p += n;
+		left -= n;
+	    }
+	    munmap(map, span);
+	    return true;
+	}
+    }
+#endif /* USE_MMAP */
+    return false;
+}
 
-    return rv;
+static void copy_blob(const blob_extent *extent)
+/* ship a spooled blob */
+{
+    static char buf[65536];
+    off_t offset;
+    size_t left;
+
+    if (extent->length >= ZERO_COPY_MIN
+	&& send_blob(extent->offset, extent->length))
+	return;
+    for (offset = extent->offset, left = extent->length; left > 0; ) {
+	ssize_t n = pread(spool, buf, left < sizeof(buf) ? left : sizeof(buf),
+			  offset);
+
+	if (n <= 0)
+	    fatal_system_error("reading blob spool");
+	(void)fwrite(buf, 1, n, stdout);
+	offset += n;
+	left -= n;
+    }
 }
 
 static void cleanup(const export_options_t *opts)
 {
-    nftw(blobdir, unlink_cb, 64, FTW_DEPTH | FTW_PHYS);
+    size_t i;
+
+    if (spool != -1)
+	close(spool);
+    spool = -1;
+    for (i = 0; i < sizeof(extents) / sizeof(extents[0]); i++) {
+	free(extents[i]);
+	extents[i] = NULL;
+    }
+}
+
+static void *generate_worker(void *arg)
+/* generate the snapshots of masters until there are none left */
+{
+    for (;;) {
+	size_t i = __atomic_fetch_add(&next_generator, 1, __ATOMIC_RELAXED);
+	size_t done;
+
+	if (i >= ngenerators)
+	    return NULL;
+	generate_files(&generators[i], first_serial[i], arg, export_blob);
+	generator_free(&generators[i]);
+	done = __atomic_add_fetch(&generated, 1, __ATOMIC_RELAXED);
+#ifdef THREADS
+	if (threads > 1) {
+	    if (pthread_mutex_trylock(&progress_mutex) == 0) {
+		progress_jump(done);
+		pthread_mutex_unlock(&progress_mutex);
+	    }
+	} else
+#endif /* THREADS */
+	    progress_jump(done);
+    }
+}
+
+void export_blobs_begin(const export_options_t *opts)
+/* set up blob storage, if that hasn't been done yet */
+{
+    char *tmp = getenv("TMPDIR");
+    char path[PATH_MAX];
+
+    if (spool != -1)
+	return;
+    if (tmp == NULL) 
+	tmp = "/tmp";
+    seqno = 0;
+    snapbytes = 0;
+    spool_size = 0;
+    dedup = opts->dedup_blobs;
+    dedup_hits = dedup_bytes = 0;
+    snprintf(path, sizeof(path), "%s/cvs-fast-export-XXXXXX", tmp);
+    if ((spool = mkstemp(path)) == -1)
+	fatal_error("blob spool creation failed\n");
+    (void)unlink(path);
+}
+
+void export_blobs_early(generator_t *gen)
+/* write a master's snapshots to blob storage now, then discard its generator */
+{
+    serial_t count = generator_blobs(gen);
+    size_t first;
+
+    /*
+     * Masters finish in whatever order the analysis threads get to
+     * them, so these serials aren't reproducible from run to run.
+     * That's harmless: serials only index the blob spool and the
+     * markmap, and marks are handed out in export order.
+     */
+    first = (size_t)__atomic_fetch_add(&seqno, (int)count, __ATOMIC_RELAXED) + 1;
+    if (first + count >= MAX_SERIAL_T)
+	fatal_error("snapshot sequence number too large, widen serial_t");
+    generate_files(gen, (serial_t)first, NULL, export_blob);
+    generator_free(gen);
+}
+
+void export_blobs_end(void)
+/* throw away blob storage that no export is going to use */
+{
+    cleanup(NULL);
+}
+
+static void generate_snapshots(forest_t *forest, export_options_t *opts)
+/* write every revision snapshot to blob storage */
+{
+    size_t i;
+
+    /*
+     * Blob serials are handed out up front, in the order a single
+     * thread would assign them: masters in order, and each master's
+     * snapshots in generation order.  So the output doesn't depend
+     * on which thread finishes first.
+     */
+    generators = forest->generators;
+    ngenerators = forest->filecount;
+    first_serial = xmalloc(sizeof(serial_t) * (ngenerators + 1), __func__);
+    first_serial[0] = seqno + 1;
+    for (i = 0; i < ngenerators; i++) {
+	size_t next = first_serial[i] + (size_t)generator_blobs(&generators[i]);
+
+	if (next >= MAX_SERIAL_T)
+	    fatal_error("snapshot sequence number too large, widen serial_t");
+	first_serial[i + 1] = next;
+    }
+    next_generator = generated = 0;
+
+    progress_begin("Generating snapshots...", forest->filecount);
+#ifdef THREADS
+    if (threads > 1) {
+	pthread_t *workers = xcalloc(threads, sizeof(pthread_t), __func__);
+	int t;
+
+	for (t = 0; t < threads; t++)
+	    pthread_create(&workers[t], NULL, generate_worker, opts);
+	for (t = 0; t < threads; t++)
+	    pthread_join(workers[t], NULL);
+	free(workers);
+    } else
+#endif /* THREADS */
+	generate_worker(opts);
+    progress_end("done");
+
+    seqno = first_serial[ngenerators] - 1;
+    export_stats.snapsize = snapbytes;
+    export_stats.dedup_hits = dedup_hits;
+    export_stats.dedup_bytes = dedup_bytes;
+    free(first_serial);
 }
 
 static const char *utc_offset_timestamp(const time_t *timep, const char *tz)
@@ -452,24 +718,25 @@ export_commit(git_commit *commit, const char *branch,
 
     for (op2 = operations; op2 < op; op2++) {
 	if (op2->op == 'M' && !op2->rev->emitted) {
+	    blob_extent *content = blob_content(op2->rev->serial);
+
+	    if (report && content != NULL && content->mark != 0) {
+		/* the same content already went out */
+		markmap[op2->rev->serial] = content->mark;
+		op2->rev->emitted = true;
+		export_stats.dedup_marks++;
+		continue;
+	    }
 	    markmap[op2->rev->serial] = ++mark;
 	    if (report) {
-		char path[PATH_MAX];
-		char *fn = blobfile(op2->path, op2->rev->serial, false, path);
-		FILE *rfp = fopen(fn, "r");
-		if (rfp == NULL) {
+		if (content == NULL) {
 		    warn("content for %s at %d is missing\n", op2->path, mark);
 		} else {
-		    char buf[BUFSIZ];
 		    printf("blob\nmark :%d\n", (int)mark);
-
-		    while (!feof(rfp)) {
-			size_t len = fread(buf, 1, sizeof(buf), rfp);
-			(void)fwrite(buf, 1, len, stdout);
-		    }
-		    (void) unlink(fn);
+		    copy_blob(content);
 		    op2->rev->emitted = true;
-		    (void)fclose(rfp);
+		    if (dedup)
+			content->mark = mark;
 		}
 	    }
 	}
@@ -592,6 +859,111 @@ struct commit_seq {
     bool realized;
 };
 
+/*
+ * canonicalize() places commits one at a time into a growing sequence,
+ * each just after the last commit already there that is its parent,
+ * the first commit of its own branch, or older than it.  This used to
+ * be done by sliding each commit back through an array, which is
+ * quadratic.  Instead the sequence is kept in a treap keyed implicitly
+ * by position, with each subtree's oldest date cached, so both the
+ * last older commit and the position of any given commit can be found
+ * in logarithmic time.
+ */
+typedef struct _order_node {
+    int		left, right, up;	/* -1 for none */
+    int		size;
+    unsigned	priority;
+    cvstime_t	date, oldest;
+} order_node;
+
+static order_node *order;
+
+#define order_size(t)	((t) == -1 ? 0 : order[t].size)
+
+static void order_update(int t)
+/* recompute a node's subtree summary from its children */
+{
+    order_node *n = &order[t];
+
+    n->size = 1 + order_size(n->left) + order_size(n->right);
+    n->oldest = n->date;
+    if (n->left != -1) {
+	order[n->left].up = t;
+	if (order[n->left].oldest < n->oldest)
+	    n->oldest = order[n->left].oldest;
+    }
+    if (n->right != -1) {
+	order[n->right].up = t;
+	if (order[n->right].oldest < n->oldest)
+	    n->oldest = order[n->right].oldest;
+    }
+}
+
+static int order_merge(int a, int b)
+/* join two sequences, a before b */
+{
+    if (a == -1)
+	return b;
+    if (b == -1)
+	return a;
+    if (order[a].priority > order[b].priority) {
+	order[a].right = order_merge(order[a].right, b);
+	order_update(a);
+	return a;
+    } else {
+	order[b].left = order_merge(a, order[b].left);
+	order_update(b);
+	return b;
+    }
+}
+
+static void order_split(int t, int k, int *a, int *b)
+/* cut a sequence into its first k nodes and the rest */
+{
+    if (t == -1) {
+	*a = *b = -1;
+    } else if (order_size(order[t].left) < k) {
+	order_split(order[t].right, k - order_size(order[t].left) - 1,
+		    &order[t].right, b);
+	order_update(t);
+	*a = t;
+    } else {
+	order_split(order[t].left, k, a, &order[t].left);
+	order_update(t);
+	*b = t;
+    }
+}
+
+static int order_rank(int t)
+/* position of a node in the sequence */
+{
+    int rank = order_size(order[t].left);
+
+    for (; order[t].up != -1; t = order[t].up)
+	if (order[order[t].up].right == t)
+	    rank += order_size(order[order[t].up].left) + 1;
+    return rank;
+}
+
+static int order_last_older(int t, cvstime_t date)
+/* position of the last node older than date, -1 if there is none */
+{
+    int base = 0;
+
+    while (t != -1 && order[t].oldest < date) {
+	int r = order[t].right;
+
+	if (r != -1 && order[r].oldest < date) {
+	    base += order_size(order[t].left) + 1;
+	    t = r;
+	} else if (order[t].date < date)
+	    return base + order_size(order[t].left);
+	else
+	    t = order[t].left;
+    }
+    return -1;
+}
+
 static struct commit_seq *canonicalize(git_repo *rl)
 /* copy/sort collated commits into git-fast-export order */
 {
@@ -613,13 +985,16 @@ static struct commit_seq *canonicalize(git_repo *rl)
      * way to arrange this is to reverse the branches in the array, fill
      * the array in forward order, and dump it forward order.
      */
-    struct commit_seq *history, *hp;
-    int n;
+    struct commit_seq *history, *sorted;
+    int n, i, ncommits = export_stats.export_total_commits;
     int branchbase;
     rev_ref *h;
     git_commit *c;
+    int *parent, *branchroot, *child, *sibling, *ready, nready, root;
+    int *where, nwhere;
+    unsigned seed = 0x2545f491;
 
-    history = (struct commit_seq *)xcalloc(export_stats.export_total_commits, 
+    history = (struct commit_seq *)xcalloc(ncommits, 
 					   sizeof(struct commit_seq),
 					   "export");
 #ifdef ORDERDEBUG
@@ -650,33 +1025,133 @@ static struct commit_seq *canonicalize(git_repo *rl)
     }
 
     /*
-     * Topological ordering is now correct.  Shuffle commits to make it as
-     * consistent with time order as we can without changing the topology.  To
-     * do this, we go to each commit in turn and move it as far towards the root
-     * as we can without moving it past a commit that is (a) its parent, (b) on
-     * a different branch, or (c) has an older datestamp.
+     * Topological ordering is now almost correct.  Shuffle commits to
+     * make it as consistent with time order as we can without changing
+     * the topology.  Each commit in turn goes as far towards the root as
+     * it can without moving past a commit that is (a) its parent, (b)
+     * the first on its own branch, or (c) has an older datestamp.
      *
-     * This is worse than O(n**2) in the number of commits, alas.
+     * Commits are taken in the order above except that none is taken
+     * before its parent, Kahn-style; the branch order doesn't always
+     * guarantee that, and this is what used to let a child be emitted
+     * before its parent.  The order of taking is kept in a min-heap
+     * so that when it does, the rest stays as it was.
      */
-    for (hp = history+1; hp < history + export_stats.export_total_commits; hp++) {
-	struct commit_seq sc, *tp, *bp = hp;
-#define is_parent_of(x, y) (((struct commit_seq *)x)->commit == ((struct commit_seq *)y)->commit->parent)
-#define is_branchroot_of(x, y) ((x)->head == (y)->head && (x)->isbase)
-#define is_older_than(x, y) (((struct commit_seq *)x)->commit->date < ((struct commit_seq *)y)->commit->date)
-	/* back up as far as we can */
-	while (!is_parent_of(bp-1, hp) && !is_branchroot_of(bp-1, hp) && !is_older_than(bp-1, hp))
-	    bp--;
-	if (bp < hp) {
-	    /* shift commits up and put *hp where *bp was */
-	    sc = *hp;
-	    for (tp = hp; tp > bp; tp--) {
-		tp[0] = tp[-1];
-	    }
-	    *bp = sc;
+    for (nwhere = 1; nwhere < 2 * ncommits; nwhere *= 2)
+	continue;
+    parent = xmalloc(sizeof(int) * (5 * ncommits + nwhere), "export order");
+    branchroot = parent + ncommits;
+    child = branchroot + ncommits;
+    sibling = child + ncommits;
+    ready = sibling + ncommits;
+    where = ready + ncommits;
+    order = xmalloc(sizeof(order_node) * (ncommits ? ncommits : 1), "export order");
+
+    /* find each commit's parent in the array through a pointer hash */
+#define commit_slot(c)	((unsigned)(((uintptr_t)(c) >> 4) * 0x9e3779b1) & (nwhere - 1))
+    for (i = 0; i < nwhere; i++)
+	where[i] = -1;
+    for (i = 0; i < ncommits; i++) {
+	unsigned s = commit_slot(history[i].commit);
+
+	while (where[s] != -1)
+	    s = (s + 1) & (nwhere - 1);
+	where[s] = i;
+    }
+    for (i = 0; i < ncommits; i++) {
+	git_commit *p = history[i].commit->parent;
+
+	parent[i] = -1;
+	if (p != NULL) {
+	    unsigned s;
+
+	    for (s = commit_slot(p); where[s] != -1; s = (s + 1) & (nwhere - 1))
+		if (history[where[s]].commit == p) {
+		    parent[i] = where[s];
+		    break;
+		}
+	}
+	branchroot[i] = history[i].isbase ? i : branchroot[i - 1];
+	child[i] = -1;
+    }
+#undef commit_slot
+    for (i = ncommits - 1; i >= 0; i--)
+	if (parent[i] != -1) {
+	    sibling[i] = child[parent[i]];
+	    child[parent[i]] = i;
+	}
+
+    nready = 0;
+    for (i = 0; i < ncommits; i++)
+	if (parent[i] == -1)
+	    ready[nready++] = i;	/* ascending, so already a heap */
+
+    root = -1;
+    while (nready > 0) {
+	int at, before, after, k;
+
+	/* take the earliest ready commit off the heap */
+	i = ready[0];
+	k = ready[--nready];
+	for (at = 0;;) {
+	    int m = 2 * at + 1;
+
+	    if (m >= nready)
+		break;
+	    if (m + 1 < nready && ready[m + 1] < ready[m])
+		m++;
+	    if (k <= ready[m])
+		break;
+	    ready[at] = ready[m];
+	    at = m;
+	}
+	ready[at] = k;
+
+	/* place it after the last commit it can't move past */
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	order[i].left = order[i].right = order[i].up = -1;
+	order[i].priority = seed;
+	order[i].date = history[i].commit->date;
+	order_update(i);
+	at = order_last_older(root, order[i].date);
+	if (parent[i] != -1 && (k = order_rank(parent[i])) > at)
+	    at = k;
+	if (branchroot[i] != i && (k = order_rank(branchroot[i])) > at)
+	    at = k;
+	order_split(root, at + 1, &before, &after);
+	root = order_merge(order_merge(before, i), after);
+	order[root].up = -1;
+
+	/* its children can go now */
+	for (k = child[i]; k != -1; k = sibling[k]) {
+	    for (at = nready++; at > 0 && ready[(at - 1) / 2] > k; at = (at - 1) / 2)
+		ready[at] = ready[(at - 1) / 2];
+	    ready[at] = k;
+	}
+    }
+
+    /* read the sequence back out in order */
+    sorted = (struct commit_seq *)xcalloc(ncommits ? ncommits : 1,
+					  sizeof(struct commit_seq),
+					  "export");
+    for (n = 0, i = root; i != -1 || n > 0; ) {
+	if (i != -1) {
+	    ready[n++] = i;
+	    i = order[i].left;
+	} else {
+	    i = ready[--n];
+	    *sorted++ = history[i];
+	    i = order[i].right;
 	}
     }
+    sorted -= ncommits;
 
-    return history;
+    free(order);
+    free(parent);
+    free(history);
+    return sorted;
 }
 
 void export_authors(forest_t *forest, export_options_t *opts)
@@ -712,23 +1187,67 @@ void export_authors(forest_t *forest, export_options_t *opts)
     free(history);
 }
 
+/*
+ * Tags are hashed on the commit they point at, so each exported commit
+ * looks up its own instead of scanning every tag.  A bucket keeps its
+ * tags in all_tags order, which is the order their resets go out in.
+ */
+typedef struct _tag_index {
+    tag_t	**tags;		/* in all_tags order */
+    int		*next;		/* next tag in the same bucket, or -1 */
+    int		*buckets;	/* first tag in each bucket, or -1 */
+    size_t	mask;
+} tag_index;
+
+static size_t tag_index_bucket(const tag_index *ti, const git_commit *commit)
+{
+    return (size_t)(((uintptr_t)commit >> 4) * 2654435761u) & ti->mask;
+}
+
+static void tag_index_build(tag_index *ti)
+/* index the tags that made it onto a commit */
+{
+    tag_t *t;
+    size_t nbuckets = 1;
+    int i, ntags = 0;
+
+    while (nbuckets < 2 * tag_count)
+	nbuckets <<= 1;
+    ti->mask = nbuckets - 1;
+    ti->tags = xmalloc((tag_count ? tag_count : 1) * sizeof(tag_t *), "tag index");
+    ti->next = xmalloc((tag_count ? tag_count : 1) * sizeof(int), "tag index");
+    ti->buckets = xmalloc(nbuckets * sizeof(int), "tag index");
+    memset(ti->buckets, -1, nbuckets * sizeof(int));
+    for (t = all_tags; t; t = t->next)
+	if (t->commit)
+	    ti->tags[ntags++] = t;
+    /* pushing from the back leaves each bucket in list order */
+    for (i = ntags - 1; i >= 0; i--) {
+	int *bucket = &ti->buckets[tag_index_bucket(ti, ti->tags[i]->commit)];
+	ti->next[i] = *bucket;
+	*bucket = i;
+    }
+}
+
+static void tag_index_free(tag_index *ti)
+{
+    free(ti->tags);
+    free(ti->next);
+    free(ti->buckets);
+}
+
 void export_commits(forest_t *forest, 
 		    export_options_t *opts, export_stats_t *stats)
 /* export a revision list as a git fast-import stream */
 {
     rev_ref *h;
-    tag_t *t;
+    tag_index tags;
+    int i;
     git_repo *rl = forest->git;
-    generator_t *gp;
-    int recount = 0;
-    char *tmp = getenv("TMPDIR");
-	
-    if (tmp == NULL) 
-	tmp = "/tmp";
-    seqno = mark = 0;
-    snprintf(blobdir, sizeof(blobdir), "%s/cvs-fast-export-XXXXXX", tmp);
-    if (mkdtemp(blobdir) == NULL)
-	fatal_error("temp dir creation failed\n");
+
+    /* with --early-blobs some snapshots are already there */
+    export_blobs_begin(opts);
+    mark = 0;
 
     /* an attempt to optimize output throughput */
     setvbuf(stdout, NULL, _IOFBF, BUFSIZ);
@@ -739,15 +1258,7 @@ void export_commits(forest_t *forest,
 				  forest->total_revisions + export_stats.export_total_commits + 1,
 				  "markmap allocation");
 
-    progress_begin("Generating snapshots...", forest->filecount);
-    for (gp = forest->generators; 
-	 gp < forest->generators + forest->filecount;
-	 gp++) {
-	generate_files(gp, opts, export_blob);
-	generator_free(gp);
-	progress_jump(++recount);
-    }
-    progress_end("done");
+    generate_snapshots(forest, opts);
 
     if (opts->reposurgeon)
 	fputs("#reposurgeon sourcetype cvs\n", stdout);
@@ -755,6 +1266,7 @@ void export_commits(forest_t *forest,
     struct commit_seq *history, *hp;
 
     history = canonicalize(rl);
+    tag_index_build(&tags);
 
 #ifdef ORDERDEBUG2
     fputs("Export phase 2:\n", stderr);
@@ -783,12 +1295,13 @@ void export_commits(forest_t *forest,
 	}
 	progress_jump(hp - history);
 	export_commit(hp->commit, hp->head->ref_name, report, opts);
-	for (t = all_tags; t; t = t->next)
-	    if (t->commit == hp->commit && display_date(hp->commit, markmap[hp->commit->serial], opts->force_dates) > opts->fromtime)
-		printf("reset refs/tags/%s\nfrom :%d\n\n", t->name, (int)markmap[hp->commit->serial]);
+	for (i = tags.buckets[tag_index_bucket(&tags, hp->commit)]; i >= 0; i = tags.next[i])
+	    if (tags.tags[i]->commit == hp->commit && display_date(hp->commit, markmap[hp->commit->serial], opts->force_dates) > opts->fromtime)
+		printf("reset refs/tags/%s\nfrom :%d\n\n", tags.tags[i]->name, (int)markmap[hp->commit->serial]);
     }
 
     free(history);
+    tag_index_free(&tags);
 
     for (h = rl->heads; h; h = h->next) {
 	if (display_date(h->commit, markmap[h->commit->serial], opts->force_dates) > opts->fromtime)
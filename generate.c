@@ -484,8 +484,9 @@ static void keyreplace(editbuffer_t *eb, enum markers marker)
     enum expand_mode exp = eb->Gexpand;
     char const *kw = Keyword[(int)marker];
     time_t utime = RCS_EPOCH + eb->Gversion->date;
+    struct tm tm;
 
-    strftime(date_string, 25, "%Y/%m/%d %H:%M:%S", localtime(&utime));
+    strftime(date_string, 25, "%Y/%m/%d %H:%M:%S", localtime_r(&utime, &tm));
 
     if (exp != EXPANDKV) {
         out_printf(eb, "%c%s", KDELIM, kw);
@@ -566,8 +567,8 @@ static void keyreplace(editbuffer_t *eb, enum markers marker)
 	if (exp != EXPANDKV)
 	    out_putc(eb, KDELIM);
 
-	kw = eb->Glog;
-	ls = strlen(eb->Glog);
+	kw = cvs_log_atom(eb->Glog);
+	ls = strlen(kw);
 	if (sizeof(ciklog)-1<=ls && !memcmp(kw,ciklog,sizeof(ciklog)-1))
 	    return;
 
@@ -866,7 +867,7 @@ static void process_delta(editbuffer_t *eb,
     struct diffcmd dc;
     uchar *ptr;
 
-    eb->Glog = node->patch->log;
+    eb->Glog = &node->patch->log;
     in_buffer_init(eb, Gnode_text(eb), true);
     eb->Gversion = node->version;
     cvs_number_string(eb->Gversion->number, eb->Gversion_number, sizeof(eb->Gversion_number));
@@ -1075,10 +1076,30 @@ static void generate_wrap(generator_t *gen)
     unload_all_text(eb);
 }
 
-void generate_files(generator_t *gen,
+serial_t generator_blobs(const generator_t *gen)
+/* how many snapshots generate_files() will pass to its hook */
+{
+    serial_t count = 0;
+    int i;
+
+    for (i = 0; i < NODE_HASH_SIZE; i++) {
+	const node_t *node;
+
+	for (node = gen->nodehash.table[i]; node; node = node->hash_next)
+	    if (node->commit != NULL && !node->commit->dead)
+		count++;
+    }
+    return count;
+}
+
+void generate_files(generator_t *gen, serial_t serial,
 		    export_options_t *opts,
-		    void(*hook)(node_t *node, void *buf, size_t len, export_options_t *opts))
-/* export all the revision states of a CVS/RCS master through a hook */
+		    void(*hook)(node_t *node, serial_t serial,
+				void *buf, size_t len, export_options_t *opts))
+/*
+ * export all the revision states of a CVS/RCS master through a hook,
+ * numbering them consecutively from serial
+ */
 {
     editbuffer_t *eb = &gen->editbuffer;
     node_t *node = generate_setup(gen);
@@ -1096,7 +1117,8 @@ void generate_files(generator_t *gen,
 		expandedit(eb);
 	    else
 		snapshotedit(eb);
-	    hook(node, out_buffer_text(eb), out_buffer_count(eb), opts);
+	    hook(node, serial++,
+		 out_buffer_text(eb), out_buffer_count(eb), opts);
 	    out_buffer_cleanup(eb);
 	}
 	node = node->down;
@@ -12,6 +12,9 @@
 extern void yyerror(yyscan_t, cvs_file *, const char *);
 
 extern YY_DECL;	/* FIXME: once the Bison bug requiring this is fixed */
+
+/* the log CVS gives a file's first revision, delimiters and all */
+#define INITIAL_LOG	"@Initial revision\n@"
 %}
 
 /*
@@ -62,7 +65,7 @@ extern YY_DECL;	/* FIXME: once the Bison bug requiring this is fixed */
 %token <number>	NUMBER
 
 %type <text>	text
-%type <s>	log
+%type <text>	log
 %type <symbol>	accesslist logins
 %type <symbol>	symbollist symbol symbols
 %type <version>	revision
@@ -155,7 +158,8 @@ symbols		: symbols symbol
 		;
 symbol		: name COLON NUMBER
 		  {
-		  	$$ = xcalloc (1, sizeof (cvs_symbol), "making symbol");
+		  	$$ = arena_alloc(&cvsfile->arena, sizeof(cvs_symbol),
+					 "making symbol");
 			$$->symbol_name = $1;
 			$$->number = atom_cvs_number($3);
 		  }
@@ -193,8 +197,8 @@ ignored         : owner | group | deltatype | kopt |
 
 revision	: NUMBER date author state branches next revtrailer
 		  {
-		    $$ = xcalloc (1, sizeof (cvs_version),
-				    "gram.y::revision");
+		    $$ = arena_alloc(&cvsfile->gen.nodehash.arena, sizeof(cvs_version),
+				     "gram.y::revision");
 		    $$->number = atom_cvs_number($1);
 		    $$->date = $2;
 		    $$->author = $3;
@@ -235,8 +239,8 @@ branches	: BRANCHES numbers SEMI
 		;
 numbers		: NUMBER numbers
 		  {
-			$$ = xcalloc (1, sizeof (cvs_branch),
-				    "gram.y::numbers");
+			$$ = arena_alloc(&cvsfile->gen.nodehash.arena, sizeof(cvs_branch),
+					 "gram.y::numbers");
 			$$->next = $2;
 			$$->number = atom_cvs_number($1);
 			hash_branch(&cvsfile->gen.nodehash, $$);
@@ -264,23 +268,26 @@ patches		: patches patch
 		  { $$ = &cvsfile->gen.patches; }
 		;
 patch		: NUMBER log text
-		  { $$ = xcalloc (1, sizeof (cvs_patch), "gram.y::patch");
+		  { $$ = arena_alloc(&cvsfile->gen.nodehash.arena, sizeof(cvs_patch),
+				     "gram.y::patch");
 		    $$->number = atom_cvs_number($1);
-		    if (!strcmp($2, "Initial revision\n")) {
+		    /* "Initial revision" has no @ to escape, so compare it raw */
+		    if ($2.length == sizeof(INITIAL_LOG) - 1 &&
+			!memcmp(cvsfile->text + $2.offset, INITIAL_LOG, $2.length)) {
 			    /* description is available because the
 			     * desc production has already been reduced */
 			    if (strlen(cvsfile->description) == 0)
-				    $$->log = atom("*** empty log message ***\n");
+				    $$->log.atom = atom("*** empty log message ***\n");
 			    else
-				    $$->log = atom(cvsfile->description);
+				    $$->log.atom = atom(cvsfile->description);
 		    } else
-			    $$->log = atom($2);
+			    /* left in the master until collation wants it */
+			    $$->log.text = $2;
 		    $$->text = $3;
 		    hash_patch(&cvsfile->gen.nodehash, $$);
-		    free($2);
 		  }
 		;
-log		: LOG DATA
+log		: LOG TEXT_DATA
 		  { $$ = $2; }
 		;
 text		: TEXT TEXT_DATA
@@ -3,9 +3,13 @@
  *
  *  SPDX-License-Identifier: GPL-2.0+
  */
+#include <fcntl.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#ifdef USE_MMAP
+#include <sys/mman.h>
+#endif /* USE_MMAP */
 #ifdef THREADS
 #include <pthread.h>
 #endif /* THREADS */
@@ -22,11 +26,13 @@
 typedef struct _rev_filename {
     struct _rev_filename	*next;
     const char			*file;
+    master_stat			st;
 } rev_filename;
 
 typedef struct _rev_file {
     const char *name;
     const char *rectified;
+    master_stat st;
 } rev_file;
 /*
  * Ugh...least painful way to make some stuff that isn't thread-local
@@ -35,29 +41,50 @@ typedef struct _rev_file {
 static rev_filename         *fn_head = NULL, **fn_tail = &fn_head, *fn;
 /* Slabs to be sorted in path_deep_compare order */
 static rev_file             *sorted_files;
+/* Indices into sorted_files, in the order workers take them */
+static size_t               *dispatch_order;
+/* Batches of dispatch_order handed out whole; batch k is [k, k+1) */
+static size_t               *batch_start;
+static size_t               next_batch, nbatches;
 static cvs_master           *cvs_masters;
 static rev_master           *rev_masters;
-static volatile size_t      fn_i = 0, fn_n;
-static volatile cvstime_t   skew_vulnerable;
-static volatile size_t      total_revisions, load_current_file;
-static volatile generator_t *generators;
-static volatile int         err;
+static size_t               load_current_file;
+static generator_t          *generators;
 
 static int total_files, striplen;
 static int verbose;
+static const char *parse_cache;
+static bool early_blobs;
 
 #ifdef THREADS
-static pthread_mutex_t revlist_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t enqueue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t progress_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_t *workers;
 #endif /* THREADS */
 
+/*
+ * Masters smaller than this get handed to workers in batches, so
+ * a tree of many tiny files isn't dominated by queue traffic.
+ */
+#define BATCH_BYTES	(64 * 1024)
+#define BATCH_MAX	64
+
 typedef struct _analysis {
     cvstime_t skew_vulnerable;
     unsigned int total_revisions;
+    bool cached;
+    int errors;
     generator_t generator;
 } analysis_t;
 
+typedef struct _worker_totals {
+    /* what one worker accumulated, merged after the join */
+    cvstime_t skew_vulnerable;
+    size_t total_revisions;
+    size_t cache_hits;
+    int errors;
+    struct timespec idle;	/* when it found the queue empty */
+} worker_totals_t;
+
 static cvs_master *
 sort_cvs_masters(cvs_master *list);
 
@@ -115,43 +142,167 @@ atom_rectify_name(const char *raw)
     return atom(rectify_name(raw, rectified, sizeof(rectified)));
 }
 
+/*
+ * The scanner is given the whole master as one buffer, which flex
+ * requires to end in two NULs and which it writes into as it goes
+ * (it NUL-terminates yytext in place).  When the slack at the end of
+ * the last page of the file has room for the NULs, a private mapping
+ * provides all of that for free; otherwise read the master into
+ * memory in one go.
+ */
+
+static char *
+load_master(int fd, size_t size, const char *name, bool *mapped)
+/* get the contents of a master as a scanner buffer */
+{
+    char *text;
+    size_t got;
+#ifdef USE_MMAP
+    size_t pagesize = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (size % pagesize != 0 && pagesize - size % pagesize >= 2) {
+	text = mmap(NULL, size + 2, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (text == MAP_FAILED)
+	    fatal_system_error("mmap: %s %zu", name, size);
+	*mapped = true;
+	return text;
+    }
+#endif /* USE_MMAP */
+    *mapped = false;
+    text = xmalloc(size + 2, __func__);
+    for (got = 0; got < size; ) {
+	ssize_t n = read(fd, text + got, size - got);
+	if (n <= 0)
+	    fatal_system_error("read: %s", name);
+	got += n;
+    }
+    text[size] = text[size + 1] = '\0';
+    return text;
+}
+
 static void
-rev_list_file(rev_file *file, analysis_t *out, cvs_master *cm, rev_master *rm) 
+unload_master(char *text, size_t size, bool mapped)
+{
+#ifdef USE_MMAP
+    if (mapped) {
+	munmap(text, size + 2);
+	return;
+    }
+#endif /* USE_MMAP */
+    free(text);
+}
+
+static void
+master_stat_fill(master_stat *st, const struct stat *buf)
+{
+    st->size = buf->st_size;
+    st->mtime = buf->st_mtime;
+#if defined(__APPLE__)
+    st->mtime_nsec = buf->st_mtimespec.tv_nsec;
+#else
+    st->mtime_nsec = buf->st_mtim.tv_nsec;
+#endif
+    st->ino = buf->st_ino;
+    st->mode = buf->st_mode;
+}
+
+static bool
+rev_list_parse(const rev_file *file, cvs_file *cvs)
+/* run a master through the grammar, false if it can't be opened */
 {
     struct stat	buf;
+    master_stat st;
     yyscan_t scanner;
-    FILE *in;
-    cvs_file *cvs;
+    int fd;
+    bool mapped, parsed;
 
-    in = fopen(file->name, "r");
-    if (!in) {
+    fd = open(file->name, O_RDONLY);
+    if (fd == -1) {
 	perror(file->name);
-	++err;
-	return;
+	return false;
     }
-    if (stat(file->name, &buf) == -1) {
+    if (fstat(fd, &buf) == -1) {
 	fatal_system_error("%s", file->name);
     }
 
+    cvs->mode = buf.st_mode;
+    cvs->textsize = buf.st_size;
+    cvs->text = load_master(fd, cvs->textsize, file->name, &mapped);
+    close(fd);
+
+    yylex_init(&scanner);
+    yy_scan_buffer(cvs->text, cvs->textsize + 2, scanner);
+    parsed = yyparse(scanner, cvs) == 0;
+    yylex_destroy(scanner);
+
+    unload_master(cvs->text, cvs->textsize, mapped);
+    cvs->text = NULL;
+
+    /* key the entry on what was actually read, not the earlier stat() */
+    if (parse_cache != NULL && parsed) {
+	master_stat_fill(&st, &buf);
+	parsecache_save(parse_cache, file->name, &st, cvs);
+    }
+    return true;
+}
+
+static void
+detach_logs(rev_master *rm)
+/* move the master's log messages out of its patches, interned */
+{
+    cvs_log *logs = xmalloc(sizeof(cvs_log) * (rm->ncommits ? rm->ncommits : 1),
+			    "detached logs");
+    serial_t i;
+
+    for (i = 0; i < rm->ncommits; i++) {
+	cvs_commit *c = &rm->commits[i];
+
+	if (c->log != NULL) {
+	    logs[i] = *c->log;
+	    c->log = &logs[i];
+	}
+    }
+    cvs_master_logs(rm);
+}
+
+static void
+rev_list_file(rev_file *file, analysis_t *out, cvs_master *cm, rev_master *rm) 
+{
+    cvs_file *cvs;
+
     cvs = xcalloc(1, sizeof(cvs_file), __func__);
     cvs->gen.master_name = file->name;
     cvs->gen.expand = EXPANDKB;
     cvs->export_name = file->rectified;
-    cvs->mode = buf.st_mode;
     cvs->verbose = verbose;
 
-    yylex_init(&scanner);
-    yyset_in(in, scanner);
-    yyparse(scanner, cvs);
-    yylex_destroy(scanner);
+    out->cached = parse_cache != NULL
+	&& parsecache_load(parse_cache, file->name, &file->st, cvs);
+    if (out->cached)
+	cvs->mode = file->st.mode;
+    else if (!rev_list_parse(file, cvs)) {
+	out->errors++;
+	free(cvs);
+	return;
+    }
 
-    fclose(in);
     if (cvs_master_digest(cvs, cm, rm) == NULL) {
 	warn("warning - master file %s has no revision number - ignore file\n", file->name);
 	cvs->gen.master_name = NULL;	/* blank out data of previous file */
     } else {
 	out->total_revisions = cvs->nversions;
 	out->skew_vulnerable = cvs->skew_vulnerable;
+	/*
+	 * With --early-blobs, snapshot the master while its pages are
+	 * still in cache and drop the generator, rather than keeping
+	 * every master's versions and patches through collation and
+	 * reading them all back cold at export time.  The logs have to
+	 * be moved out first; commits point at them in the patches.
+	 */
+	if (early_blobs) {
+	    detach_logs(rm);
+	    export_blobs_early(&cvs->gen);
+	}
     }
     out->generator = cvs->gen;
     cvs_file_free(cvs);
@@ -178,42 +329,51 @@ strcommonendingwith(const char *a, const char *b, char endc)
 }
 
 static void *worker(void *arg)
-/* consume masters off the queue */
+/* consume batches of masters off the queue */
 {
+    worker_totals_t *totals = arg;
     analysis_t out = {0, 0};
+
     for (;;)
     {
-	/* pop a master off the queue, terminating if none left */
-#ifdef THREADS
-	if (threads > 1)
-	    pthread_mutex_lock(&enqueue_mutex);
-#endif /* THREADS */
-	size_t i = fn_i++;
-#ifdef THREADS
-	if (threads > 1)
-	    pthread_mutex_unlock(&enqueue_mutex);
-#endif /* THREADS */
-	if (i >= fn_n)
-	    return(NULL);
+	/* claim a batch, terminating if none left */
+	size_t k = __atomic_fetch_add(&next_batch, 1, __ATOMIC_RELAXED);
+	size_t n;
 
-	/* process it */
-	rev_list_file(&sorted_files[i], &out, &cvs_masters[i], &rev_masters[i]);
-
-	/* pass it to the next stage */
-#ifdef THREADS
-	if (threads > 1)
-	    pthread_mutex_lock(&revlist_mutex);
-#endif /* THREADS */
-	if ((generators[i] = out.generator).master_name != NULL) {
-	    progress_jump(++load_current_file);
-	    total_revisions += out.total_revisions;
-	    if (out.skew_vulnerable > skew_vulnerable)
-		skew_vulnerable = out.skew_vulnerable;
+	if (k >= nbatches) {
+	    clock_gettime(CLOCK_REALTIME, &totals->idle);
+	    return(NULL);
 	}
+	for (n = batch_start[k]; n < batch_start[k + 1]; n++) {
+	    size_t i = dispatch_order[n];
+
+	    /* process it */
+	    out.errors = 0;
+	    out.generator.master_name = NULL;
+	    rev_list_file(&sorted_files[i], &out, &cvs_masters[i], &rev_masters[i]);
+
+	    /* pass it to the next stage; each slot has only one writer */
+	    totals->errors += out.errors;
+	    if ((generators[i] = out.generator).master_name != NULL) {
+		totals->total_revisions += out.total_revisions;
+		if (out.cached)
+		    totals->cache_hits++;
+		if (out.skew_vulnerable > totals->skew_vulnerable)
+		    totals->skew_vulnerable = out.skew_vulnerable;
+	    }
+	}
+	n = __atomic_add_fetch(&load_current_file, n - batch_start[k],
+			       __ATOMIC_RELAXED);
 #ifdef THREADS
-	if (threads > 1)
-	    pthread_mutex_unlock(&revlist_mutex);
+	/* a worker that can't print right now leaves it to the next */
+	if (threads > 1) {
+	    if (pthread_mutex_trylock(&progress_mutex) == 0) {
+		progress_jump(n);
+		pthread_mutex_unlock(&progress_mutex);
+	    }
+	} else
 #endif /* THREADS */
+	    progress_jump(n);
     }
 }
 
@@ -291,6 +451,18 @@ path_deep_compare(const void *a, const void *b)
     return compar;
 }
 
+static int
+dispatch_compare(const void *a, const void *b)
+/* biggest masters first, so no thread is left with a giant at the end */
+{
+    size_t i = *(const size_t *)a, j = *(const size_t *)b;
+    off_t si = sorted_files[i].st.size, sj = sorted_files[j].st.size;
+
+    if (si != sj)
+	return si < sj ? 1 : -1;
+    return i < j ? -1 : i > j;
+}
+
 static int 
 file_compare(const void *f1, const void *f2)
 {
@@ -305,6 +477,10 @@ void analyze_masters(int argc, const char *argv[],
 /* main entry point; collect and parse CVS masters */
 {
     char	    name[PATH_MAX];
+    char	    straggle[64], cached[64];
+    worker_totals_t *totals, all;
+    struct timespec first_idle;
+    int		    nworkers;
     const char      *last = NULL;
     char	    *file;
     size_t	    i, j = 1;
@@ -368,6 +544,7 @@ void analyze_masters(int argc, const char *argv[],
 		    striplen = i + 1;
 	}
 	fn->file = atom(file);
+	master_stat_fill(&fn->st, &stb);
 	last = fn->file;
 	total_files++;
 	if (progress && total_files % 100 == 0)
@@ -379,12 +556,12 @@ void analyze_masters(int argc, const char *argv[],
     sorted_files = xmalloc(sizeof(rev_file) * total_files, "sorted_files");
     cvs_masters = xcalloc(total_files, sizeof(cvs_master), "cvs_masters");
     rev_masters = xmalloc(sizeof(rev_master) * total_files, "rev_masters");
-    fn_n = total_files;
     i = 0;
     rev_filename *tn;
     for (fn = fn_head; fn; fn = tn) {
 	tn = fn->next;
 	sorted_files[i].name = fn->file;
+	sorted_files[i].st = fn->st;
 	sorted_files[i++].rectified = atom_rectify_name(fn->file);
 	free(fn);
     }
@@ -397,6 +574,35 @@ void analyze_masters(int argc, const char *argv[],
      * e.g. .cvsignore becomes .gitignore
      */
     qsort(sorted_files, total_files, sizeof(rev_file), file_compare);
+
+    /*
+     * Results still land in the slots above, but with threads the
+     * workers take the masters longest-first by size, which is a fair
+     * proxy for the time they take.  Taking them in path order can
+     * leave every thread but one idle while a huge ChangeLog,v at the
+     * end of the list is chewed through.
+     */
+    dispatch_order = xmalloc(sizeof(size_t) * total_files, "dispatch order");
+    for (i = 0; i < (size_t)total_files; i++)
+	dispatch_order[i] = i;
+#ifdef THREADS
+    if (threads > 1)
+	qsort(dispatch_order, total_files, sizeof(size_t), dispatch_compare);
+#endif /* THREADS */
+    batch_start = xmalloc(sizeof(size_t) * (total_files + 1), "batches");
+    nbatches = 0;
+    for (i = 0; i < (size_t)total_files; ) {
+	size_t first = i;
+	off_t bytes = 0;
+
+	batch_start[nbatches++] = first;
+	do
+	    bytes += sorted_files[dispatch_order[i++]].st.size;
+	while (i < (size_t)total_files
+	       && i - first < BATCH_MAX && bytes < BATCH_BYTES);
+    }
+    batch_start[nbatches] = total_files;
+    next_batch = 0;
 	
     progress_end("done, %.3fKB in %d files",
 		 (forest->textsize/1024.0), forest->filecount);
@@ -404,6 +610,8 @@ void analyze_masters(int argc, const char *argv[],
     /* things that must be visible to inner functions */
     load_current_file = 0;
     verbose = analyzer->verbose;
+    parse_cache = analyzer->parse_cache;
+    early_blobs = analyzer->early_blobs;
 
     /*
      * Analyze the files for CVS revision structure.
@@ -421,6 +629,12 @@ void analyze_masters(int argc, const char *argv[],
 #endif /* THREADS */
 	strcpy(name, "Analyzing masters...");
     progress_begin(name, total_files);
+    nworkers = 1;
+#ifdef THREADS
+    if (threads > 1)
+	nworkers = threads;
+#endif /* THREADS */
+    totals = xcalloc(nworkers, sizeof(worker_totals_t), "worker totals");
 #ifdef THREADS
     if (threads > 1)
     {
@@ -428,27 +642,56 @@ void analyze_masters(int argc, const char *argv[],
 
 	workers = (pthread_t *)xcalloc(threads, sizeof(pthread_t), __func__);
 	for (i = 0; i < threads; i++)
-	    pthread_create(&workers[i], &attr, worker, NULL);
+	    pthread_create(&workers[i], &attr, worker, &totals[i]);
 
         /* Wait for all the threads to die off. */
 	for (i = 0; i < threads; i++)
           pthread_join(workers[i], NULL);
         
-	pthread_mutex_destroy(&enqueue_mutex);
-	pthread_mutex_destroy(&revlist_mutex);
+	pthread_mutex_destroy(&progress_mutex);
+	free(workers);
+	sort_tags();
     }
     else
 #endif /* THREADS */
-	worker(NULL);
+	worker(&totals[0]);
+
+    /* merge what the workers found */
+    memset(&all, '\0', sizeof(all));
+    for (i = 0; i < (size_t)nworkers; i++) {
+	all.total_revisions += totals[i].total_revisions;
+	all.cache_hits += totals[i].cache_hits;
+	all.errors += totals[i].errors;
+	if (totals[i].skew_vulnerable > all.skew_vulnerable)
+	    all.skew_vulnerable = totals[i].skew_vulnerable;
+	/* how long the last straggler kept the first idle thread waiting */
+	if (i == 0 || seconds_diff(&totals[i].idle, &first_idle) < 0)
+	    first_idle = totals[i].idle;
+	if (i == 0 || seconds_diff(&totals[i].idle, &all.idle) > 0)
+	    all.idle = totals[i].idle;
+    }
+    free(totals);
 
-    progress_end("done, %d revisions", (int)total_revisions);
+    straggle[0] = cached[0] = '\0';
+#ifdef THREADS
+    if (threads > 1)
+	snprintf(straggle, sizeof(straggle), ", %.3fsec of straggling",
+		 seconds_diff(&all.idle, &first_idle));
+#endif /* THREADS */
+    if (parse_cache != NULL)
+	snprintf(cached, sizeof(cached), ", %d of %d masters from parse cache",
+		 (int)all.cache_hits, total_files);
+    progress_end("done, %d revisions%s%s",
+		 (int)all.total_revisions, cached, straggle);
+    free(batch_start);
+    free(dispatch_order);
     free(sorted_files);
 
-    forest->errcount = err;
-    forest->total_revisions = total_revisions;
-    forest->skew_vulnerable = skew_vulnerable;
+    forest->errcount = all.errors;
+    forest->total_revisions = all.total_revisions;
+    forest->skew_vulnerable = all.skew_vulnerable;
     forest->cvs = cvs_masters;
-    forest->generators = (generator_t *)generators;
+    forest->generators = generators;
 }
 
 /* end */
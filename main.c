@@ -221,11 +221,14 @@ main(int argc, char **argv)
             { "incremental",        1, 0, 'i' },
             { "threads",	    1, 0, 't' },
             { "embed-id",           0, 0, 'E' },
+            { "parse-cache",        1, 0, 'C' },
+            { "early-blobs",        0, 0, 'B' },
+            { "dedup-blobs",        0, 0, 'D' },
 	    { "sizes",              0, 0, 'S' },	/* undocumented */
 	    { "noignores",          0, 0, 'N' },	/* undocumented */
 	    { NULL,                 0, 0, '\0'}, 
 	};
-	int c = getopt_long(argc, argv, "+hVw:cl:grvqaA:R:Tk:e:s:pPi:t:SEN", options, NULL);
+	int c = getopt_long(argc, argv, "+hVw:cl:grvqaA:R:Tk:e:s:pPi:t:SENC:BD", options, NULL);
 	if (c < 0)
 	    break;
 	switch(c) {
@@ -253,6 +256,9 @@ main(int argc, char **argv)
 		   " -i --incremental=TIME           Incremental dump beginning after specified RFC3339-format TIME.\n"
 		   " -t --threads=N                  Use threaded scheduler with N threads for CVS master analyses.\n"
 		   " -E --embed-id                   Embed CVS revisions in the commit messages.\n"
+		   " -C --parse-cache=DIR            Keep parsed masters in DIR for reuse by later runs.\n"
+		   " -B --early-blobs                Write file snapshots while masters are analyzed.\n"
+		   " -D --dedup-blobs                Emit each distinct file content only once.\n"
 		   "\n"
 		   "Example: find | cvs-fast-export\n");
 	    return 0;
@@ -342,6 +348,18 @@ main(int argc, char **argv)
 	case 'N':
 	    noignores = true;
 	    break;
+	case 'C':
+	    assert(optarg);
+	    if (mkdir(optarg, 0777) == -1 && errno != EEXIST)
+		fatal_system_error("cannot create parse cache %s", optarg);
+	    import_options.parse_cache = optarg;
+	    break;
+	case 'B':
+	    import_options.early_blobs = true;
+	    break;
+	case 'D':
+	    export_options.dedup_blobs = true;
+	    break;
 	default: /* error message already emitted */
 	    announce("try `%s --help' for more information.\n", argv[0]);
 	    return 1;
@@ -364,6 +382,12 @@ main(int argc, char **argv)
 #endif /*  _SC_NPROCESSORS_ONLN */
 #endif
 
+    /* only an export has any use for the snapshots */
+    if (exec_mode != ExecuteExport)
+	import_options.early_blobs = false;
+    if (import_options.early_blobs)
+	export_blobs_begin(&export_options);
+
     gather_stats("before parsing");
 
     /* build CVS structures by parsing masters; may read stdin */
@@ -393,7 +417,8 @@ main(int argc, char **argv)
 		fclose(export_options.revision_map);
 	    break;
 	}
-    }
+    } else if (import_options.early_blobs)
+	export_blobs_end();
 
     gather_stats("total");
 
@@ -415,6 +440,12 @@ main(int argc, char **argv)
 		export_stats.snapsize / 1000000.0,
 		natoms,
 		(int)(export_stats.export_total_commits / elapsed));
+	if (export_options.dedup_blobs)
+	    fprintf(STATUS, "%ld duplicate snapshots, %.3fM not spooled, %ld blobs not emitted.\n",
+		    export_stats.dedup_hits,
+		    export_stats.dedup_bytes / 1000000.0,
+		    export_stats.dedup_marks);
+	atom_stats(STATUS);
     }
 
     if (LOGFILE != stderr) {
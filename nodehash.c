@@ -30,13 +30,16 @@ node_for_cvs_number(nodehash_t *context, const cvs_number *const n)
 	    return p;
 
     /*
-     * While it looks like a good idea, an attempt at slab allocation
-     * failed miserably here.  Noted because the regression-test
-     * suite didn't catch it.  Attempting to convert groff did.  The
-     * problem shows as difficult-to-interpret errors under valgrind.
+     * An earlier attempt at slab allocation failed miserably here.
+     * The regression-test suite didn't catch it; converting groff
+     * did, as difficult-to-interpret errors under valgrind.  The
+     * arena keeps its unused space poisoned for ASan and valgrind,
+     * and "make asan-check" runs the tests with every node allocated
+     * and poisoned separately, so a repeat should not go unnoticed.
      */
-    p = xcalloc(1, sizeof(node_t), "hash number generation");
+    p = arena_alloc(&context->arena, sizeof(node_t), "hash number generation");
     p->number = k;
+    p->key = cvs_number_pack(k);
     p->hash_next = context->table[hash];
     context->table[hash] = p;
     context->nentries++;
@@ -52,7 +55,7 @@ static node_t *find_parent(nodehash_t *context,
     node_t *p;
     hash_t hash;
 
-    memcpy(&key, n, sizeof(cvs_number));
+    cvs_number_copy(&key, n);
     key.c -= depth;
     k = atom_cvs_number(key);
     hash = hash_cvs_number(k) % NODE_HASH_SIZE;
@@ -106,18 +109,10 @@ void hash_branch(nodehash_t *context, cvs_branch *b)
 }
 
 void clean_hash(nodehash_t *context)
-/* discard the node list */
+/* discard the node list, and the versions and patches in the arena */
 {
-    int i;
-    for (i = 0; i < NODE_HASH_SIZE; i++) {
-	node_t *p = context->table[i];
-	context->table[i] = NULL;
-	while (p) {
-	    node_t *q = p->hash_next;
-	    free(p);
-	    p = q;
-	}
-    }
+    memset(context->table, '\0', sizeof(context->table));
+    arena_free(&context->arena);
     context->nentries = 0;
     context->head_node = NULL;
 }
@@ -132,6 +127,8 @@ static int compare(const void *a, const void *b)
 	return -1;
     if (n > y->number->c)
 	return 1;
+    if (n <= CVS_PACKED_DEPTH)
+	return x->key < y->key ? -1 : x->key > y->key;
     for (i = 0; i < n; i++) {
 	if (x->number->n[i] < y->number->n[i])
 	    return -1;
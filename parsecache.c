@@ -0,0 +1,474 @@
+/*
+ * On-disk cache of parsed CVS masters, for --parse-cache.
+ *
+ * Each master gets one file in the cache directory holding what the
+ * grammar extracted from it: symbols, versions and patches, with log
+ * and delta texts still as offsets into the master.  An entry is only
+ * believed if the master's path, size, mtime and inode match the ones
+ * it was written with, the mtime to the nanosecond so that a master
+ * rewritten within the same second isn't mistaken for the old one;
+ * anything else is a miss and the master is parsed as usual, and the
+ * entry rewritten.  Whatever cvs_master_digest() does afterwards is
+ * redone on every run.
+ *
+ * Entries are written to a temporary file and renamed into place, so
+ * concurrent runs and threads never see a partial one.  Integers are
+ * stored in host order; the magic number at the front catches a cache
+ * carried to a machine of the other endianness.  Bump PARSECACHE_VERSION
+ * whenever what gets stored changes.
+ *
+ *  SPDX-License-Identifier: GPL-2.0+
+ */
+
+#include <fcntl.h>
+
+#include "cvs.h"
+
+#define PARSECACHE_MAGIC	0x63666570	/* "cfep" */
+#define PARSECACHE_VERSION	2
+
+#define NO_STRING	UINT32_MAX	/* length marking a NULL string */
+#define NO_NUMBER	0xff		/* count marking a NULL cvs_number */
+
+enum log_kind {LOG_TEXT, LOG_ATOM};
+
+typedef struct _cache_buffer {
+    char	*base;
+    size_t	len, alloc;
+} cache_buffer;
+
+typedef struct _cache_cursor {
+    const char	*p, *end;
+    bool	bad;
+} cache_cursor;
+
+static char *
+cache_path(const char *dir, const char *name, char *path, size_t pathlen)
+/* where the entry for a master lives; collisions are caught on load */
+{
+    uint64_t hash = 14695981039346656037ULL;	/* 64-bit FNV-1a */
+    const char *s;
+
+    for (s = name; *s; s++)
+	hash = (hash ^ (uint8_t)*s) * 1099511628211ULL;
+    if (snprintf(path, pathlen, "%s/%016llx", dir,
+		 (unsigned long long)hash) >= (int)pathlen)
+	fatal_error("parse cache directory name %s too long\n", dir);
+    return path;
+}
+
+/* encoding */
+
+static void
+put(cache_buffer *b, const void *data, size_t len)
+{
+    if (b->len + len > b->alloc) {
+	b->alloc = (b->len + len) * 2;
+	b->base = xrealloc(b->base, b->alloc, "parse cache entry");
+    }
+    memcpy(b->base + b->len, data, len);
+    b->len += len;
+}
+
+static void
+put_u32(cache_buffer *b, uint32_t v)
+{
+    put(b, &v, sizeof(v));
+}
+
+static void
+put_u64(cache_buffer *b, uint64_t v)
+{
+    put(b, &v, sizeof(v));
+}
+
+static void
+put_string(cache_buffer *b, const char *s)
+{
+    if (s == NULL)
+	put_u32(b, NO_STRING);
+    else {
+	uint32_t len = strlen(s);
+	put_u32(b, len);
+	put(b, s, len);
+    }
+}
+
+static void
+put_number(cache_buffer *b, const cvs_number *n)
+{
+    uint8_t c = n ? n->c : NO_NUMBER;
+
+    put(b, &c, 1);
+    if (n)
+	put(b, n->n, n->c * sizeof(short));
+}
+
+static void
+put_text(cache_buffer *b, const cvs_text *text)
+{
+    put_u64(b, (uint64_t)text->offset);
+    put_u64(b, (uint64_t)text->length);
+}
+
+/* decoding: any overrun marks the cursor bad and yields zeroes */
+
+static const void *
+get(cache_cursor *c, size_t len)
+{
+    const char *p = c->p;
+
+    if (c->bad || (size_t)(c->end - c->p) < len) {
+	c->bad = true;
+	return NULL;
+    }
+    c->p += len;
+    return p;
+}
+
+static uint32_t
+get_u32(cache_cursor *c)
+{
+    const void *p = get(c, sizeof(uint32_t));
+    uint32_t v = 0;
+
+    if (p)
+	memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t
+get_u64(cache_cursor *c)
+{
+    const void *p = get(c, sizeof(uint64_t));
+    uint64_t v = 0;
+
+    if (p)
+	memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static const char *
+get_string(cache_cursor *c)
+/* the string comes back interned */
+{
+    uint32_t len = get_u32(c);
+    const char *p;
+    char *s;
+    const char *a;
+
+    if (len == NO_STRING || (p = get(c, len)) == NULL)
+	return NULL;
+    s = xmalloc(len + 1, "parse cache string");
+    memcpy(s, p, len);
+    s[len] = '\0';
+    a = atom(s);
+    free(s);
+    return a;
+}
+
+static const cvs_number *
+get_number(cache_cursor *c)
+/* the number comes back interned */
+{
+    const uint8_t *cp = get(c, 1);
+    const void *p;
+    cvs_number n;
+
+    if (cp == NULL || *cp == NO_NUMBER)
+	return NULL;
+    if (*cp > CVS_MAX_DEPTH) {
+	c->bad = true;
+	return NULL;
+    }
+    n.c = *cp;
+    if ((p = get(c, n.c * sizeof(short))) == NULL)
+	return NULL;
+    memcpy(n.n, p, n.c * sizeof(short));
+    return atom_cvs_number(n);
+}
+
+static void
+get_text(cache_cursor *c, cvs_text *text, const cvs_file *cvs)
+{
+    text->filename = cvs->gen.master_name;
+    text->offset = (off_t)get_u64(c);
+    text->length = (size_t)get_u64(c);
+}
+
+static void
+put_key(cache_buffer *b, const char *name, const master_stat *st)
+{
+    put_u32(b, PARSECACHE_MAGIC);
+    put_u32(b, PARSECACHE_VERSION);
+    put_u64(b, (uint64_t)st->size);
+    put_u64(b, (uint64_t)st->mtime);
+    put_u64(b, (uint64_t)st->mtime_nsec);
+    put_u64(b, (uint64_t)st->ino);
+    put_string(b, name);
+}
+
+static bool
+key_matches(cache_cursor *c, const char *name, const master_stat *st)
+{
+    uint32_t len;
+    const char *p;
+
+    if (get_u32(c) != PARSECACHE_MAGIC
+	|| get_u32(c) != PARSECACHE_VERSION
+	|| get_u64(c) != (uint64_t)st->size
+	|| get_u64(c) != (uint64_t)st->mtime
+	|| get_u64(c) != (uint64_t)st->mtime_nsec
+	|| get_u64(c) != (uint64_t)st->ino)
+	return false;
+    len = get_u32(c);
+    p = get(c, len);
+    return p != NULL && len == strlen(name) && memcmp(p, name, len) == 0;
+}
+
+void
+parsecache_save(const char *dir, const char *name,
+		const master_stat *st, const cvs_file *cvs)
+/* record the parse of a master */
+{
+    cache_buffer b = {NULL, 0, 0};
+    char path[PATH_MAX], tmp[PATH_MAX + 8];
+    const cvs_symbol *s;
+    const cvs_version *v;
+    const cvs_branch *br;
+    const cvs_patch *p;
+    uint32_t n;
+    int fd;
+
+    put_key(&b, name, st);
+    put_u32(&b, cvs->gen.expand);
+    put_u32(&b, cvs->skew_vulnerable);
+    put_number(&b, cvs->head);
+    put_number(&b, cvs->branch);
+
+    for (n = 0, s = cvs->symbols; s; s = s->next)
+	n++;
+    put_u32(&b, n);
+    for (s = cvs->symbols; s; s = s->next) {
+	put_string(&b, s->symbol_name);
+	put_number(&b, s->number);
+    }
+
+    put_u32(&b, cvs->nversions);
+    for (v = cvs->gen.versions; v; v = v->next) {
+	put_number(&b, v->number);
+	put_u32(&b, v->date);
+	put_string(&b, v->author);
+	put_string(&b, v->state);
+	put_string(&b, v->commitid);
+	put_number(&b, v->parent);
+	for (n = 0, br = v->branches; br; br = br->next)
+	    n++;
+	put_u32(&b, n);
+	for (br = v->branches; br; br = br->next)
+	    put_number(&b, br->number);
+    }
+
+    for (n = 0, p = cvs->gen.patches; p; p = p->next)
+	n++;
+    put_u32(&b, n);
+    for (p = cvs->gen.patches; p; p = p->next) {
+	put_number(&b, p->number);
+	if (p->log.atom != NULL) {
+	    put_u32(&b, LOG_ATOM);
+	    put_string(&b, p->log.atom);
+	} else {
+	    put_u32(&b, LOG_TEXT);
+	    put_text(&b, &p->log.text);
+	}
+	put_text(&b, &p->text);
+    }
+    put_u32(&b, PARSECACHE_MAGIC);
+
+    cache_path(dir, name, path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path);
+    if ((fd = mkstemp(tmp)) == -1) {
+	warn("parse cache: cannot create %s: %s\n", tmp, strerror(errno));
+	free(b.base);
+	return;
+    }
+    for (size_t done = 0; done < b.len; ) {
+	ssize_t w = write(fd, b.base + done, b.len - done);
+	if (w <= 0) {
+	    warn("parse cache: cannot write %s: %s\n", tmp, strerror(errno));
+	    close(fd);
+	    unlink(tmp);
+	    free(b.base);
+	    return;
+	}
+	done += w;
+    }
+    close(fd);
+    if (rename(tmp, path) == -1) {
+	warn("parse cache: cannot rename %s: %s\n", tmp, strerror(errno));
+	unlink(tmp);
+    }
+    free(b.base);
+}
+
+static char *
+read_entry(const char *path, size_t *len)
+/* slurp a cache entry, or NULL if there isn't one */
+{
+    struct stat st;
+    char *data;
+    size_t got;
+    int fd;
+
+    if ((fd = open(path, O_RDONLY)) == -1)
+	return NULL;
+    if (fstat(fd, &st) == -1) {
+	close(fd);
+	return NULL;
+    }
+    data = xmalloc(st.st_size ? st.st_size : 1, "parse cache entry");
+    for (got = 0; got < (size_t)st.st_size; ) {
+	ssize_t n = read(fd, data + got, st.st_size - got);
+	if (n <= 0)
+	    break;
+	got += n;
+    }
+    close(fd);
+    *len = got;
+    return data;
+}
+
+static void
+discard_parse(cvs_file *cvs)
+/* throw away a half-loaded entry */
+{
+    arena_free(&cvs->arena);
+    cvs->symbols = NULL;
+    generator_free(&cvs->gen);
+    cvs->gen.versions = NULL;
+    cvs->gen.patches = NULL;
+    cvs->head = cvs->branch = NULL;
+    cvs->nversions = 0;
+    cvs->skew_vulnerable = 0;
+}
+
+static void
+hash_branches(nodehash_t *context, cvs_branch *branch)
+/* the grammar reduces a branches list, and hashes it, last to first */
+{
+    if (branch != NULL) {
+	hash_branches(context, branch->next);
+	hash_branch(context, branch);
+    }
+}
+
+bool
+parsecache_load(const char *dir, const char *name,
+		const master_stat *st, cvs_file *cvs)
+/* fill in cvs as the grammar would have, if the cache is up to date */
+{
+    char path[PATH_MAX];
+    cache_cursor c;
+    cvs_symbol **stail = &cvs->symbols;
+    cvs_version **vtail = &cvs->gen.versions;
+    cvs_patch **ptail = &cvs->gen.patches;
+    uint32_t i, n;
+    size_t len;
+    char *data;
+
+    data = read_entry(cache_path(dir, name, path, sizeof(path)), &len);
+    if (data == NULL)
+	return false;
+    c.p = data;
+    c.end = data + len;
+    c.bad = false;
+    if (!key_matches(&c, name, st)) {
+	free(data);
+	return false;
+    }
+
+    cvs->gen.expand = get_u32(&c);
+    cvs->skew_vulnerable = get_u32(&c);
+    cvs->head = get_number(&c);
+    cvs->branch = get_number(&c);
+
+    n = get_u32(&c);
+    for (i = 0; i < n && !c.bad; i++) {
+	cvs_symbol *s = arena_alloc(&cvs->arena, sizeof(cvs_symbol),
+				    "parse cache symbol");
+	*stail = s;
+	stail = &s->next;
+	s->symbol_name = get_string(&c);
+	s->number = get_number(&c);
+    }
+
+    n = get_u32(&c);
+    for (i = 0; i < n && !c.bad; i++) {
+	cvs_version *v = arena_alloc(&cvs->gen.nodehash.arena, sizeof(cvs_version),
+				     "parse cache version");
+	cvs_branch *br, **btail = &v->branches;
+	uint32_t j, nb;
+
+	*vtail = v;
+	vtail = &v->next;
+	v->number = get_number(&c);
+	v->date = get_u32(&c);
+	v->author = get_string(&c);
+	v->state = get_string(&c);
+	v->dead = v->state != NULL && !strcmp(v->state, "dead");
+	v->commitid = get_string(&c);
+	v->parent = get_number(&c);
+	nb = get_u32(&c);
+	for (j = 0; j < nb && !c.bad; j++) {
+	    br = arena_alloc(&cvs->gen.nodehash.arena, sizeof(cvs_branch),
+			     "parse cache branch");
+	    *btail = br;
+	    btail = &br->next;
+	    br->number = get_number(&c);
+	}
+	if (v->number == NULL)
+	    c.bad = true;
+	if (c.bad)
+	    break;
+	hash_branches(&cvs->gen.nodehash, v->branches);
+	hash_version(&cvs->gen.nodehash, v);
+	cvs->nversions++;
+    }
+
+    n = get_u32(&c);
+    for (i = 0; i < n && !c.bad; i++) {
+	cvs_patch *p = arena_alloc(&cvs->gen.nodehash.arena, sizeof(cvs_patch),
+				    "parse cache patch");
+
+	*ptail = p;
+	ptail = &p->next;
+	p->number = get_number(&c);
+	switch (get_u32(&c)) {
+	case LOG_ATOM:
+	    p->log.atom = get_string(&c);
+	    break;
+	case LOG_TEXT:
+	    get_text(&c, &p->log.text, cvs);
+	    break;
+	default:
+	    c.bad = true;
+	}
+	get_text(&c, &p->text, cvs);
+	if (p->number == NULL)
+	    c.bad = true;
+	if (c.bad)
+	    break;
+	hash_patch(&cvs->gen.nodehash, p);
+    }
+
+    if (c.bad || get_u32(&c) != PARSECACHE_MAGIC || c.p != c.end) {
+	warn("parse cache: ignoring damaged entry %s for %s\n", path, name);
+	discard_parse(cvs);
+	free(data);
+	return false;
+    }
+    free(data);
+    return true;
+}
+
+/* end */
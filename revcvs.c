@@ -170,7 +170,7 @@ cvs_master_branch_build(cvs_file *cvs, rev_master *master, const cvs_number *bra
 #endif /* CVSDEBUG */
 
 
-    memcpy(&n, branch, sizeof(cvs_number));
+    cvs_number_copy(&n, branch);
     n.n[n.c-1] = -1;
     atom_n = atom_cvs_number(n);
     for (node = cvs_find_version(cvs, atom_n); node; node = node->next) {
@@ -187,7 +187,7 @@ cvs_master_branch_build(cvs_file *cvs, rev_master *master, const cvs_number *bra
 	commit->tail = commit->tailed = false;
 	commit->refcount = commit->serial = 0;
 	if (patch != NULL)
-	    commit->log = patch->log;
+	    commit->log = &patch->log;
 	 commit->dead = v->dead;
 	/* leave this around so the branch merging stuff can find numbers */
 	commit->master = master;
@@ -328,7 +328,7 @@ cvs_master_patch_vendor_branch(cvs_master *cm, cvs_file *cvs)
 		for (vlast = vendor->commit; vlast; vlast = vlast->parent)
 		    if (!vlast->parent)
 			break;
-		memcpy(&branch, vlast->number, sizeof(cvs_number));
+		cvs_number_copy(&branch, vlast->number);
 		/* reduce 1.1.{odd}.1 to 1.1.{odd}, and synthesize a name from that */
 		branch.c--;
 		cvs_number_string(&branch, rev, sizeof(rev));
@@ -425,7 +425,7 @@ cvs_master_graft_branches(cvs_master *cm, cvs_file *cvs)
 			    cvs_number	v_n;
 			    cvs_commit	*v_c, *n_v_c;
 			    warn("Found merge into vendor branch\n");
-			    memcpy(&v_n, cb->number, sizeof(cvs_number));
+			    cvs_number_copy(&v_n, cb->number);
 			    v_c = NULL;
 			    /*
 			     * Walk to head of vendor branch
@@ -470,7 +470,7 @@ cvs_master_find_branch(cvs_master *cm, const cvs_number *number)
 
     if (number->c < 2)
 	return NULL;
-    memcpy(&n, number, sizeof(cvs_number));
+    cvs_number_copy(&n, number);
     h = NULL;
     while (n.c >= 2) {
 	const cvs_number *k = atom_cvs_number(n);
@@ -492,6 +492,7 @@ cvs_master_set_refs(cvs_master *cm, cvs_file *cvsfile)
 {
     rev_ref	*h, **ph, *h2;
     cvs_symbol	*s;
+    int		ntags = 0;
    
     for (s = cvsfile->symbols; s; s = s->next) {
 	cvs_commit	*c = NULL;
@@ -513,7 +514,7 @@ cvs_master_set_refs(cvs_master *cm, cvs_file *cvsfile)
 	    } else {
 		cvs_number n;
 
-		memcpy(&n, s->number, sizeof(cvs_number));
+		cvs_number_copy(&n, s->number);
 		while (n.c >= 4) {
 		    n.c -= 2;
 		    c = cvs_master_find_revision(cm, atom_cvs_number(n));
@@ -529,7 +530,7 @@ cvs_master_set_refs(cvs_master *cm, cvs_file *cvsfile)
 	} else {
 	    c = cvs_master_find_revision(cm, s->number);
 	    if (c)
-		tag_commit(c, s->symbol_name, cvsfile);
+		tag_commit(c, s->symbol_name, cvsfile, ntags++);
 	}
     }
     /*
@@ -569,7 +570,7 @@ cvs_master_set_refs(cvs_master *cm, cvs_file *cvsfile)
 		 cvsfile->export_name);
 	    continue;
 	}
-	memcpy(&n, c->number, sizeof(cvs_number));
+	cvs_number_copy(&n, c->number);
 	/* convert to branch form */
 	n.n[n.c-1] = n.n[n.c-2];
 	n.n[n.c-2] = 0;
@@ -611,7 +612,7 @@ cvs_master_set_refs(cvs_master *cm, cvs_file *cvsfile)
 	}
 
 	if (h->number->c >= 4) {
-	    memcpy(&n, h->number, sizeof(cvs_number));
+	    cvs_number_copy(&n, h->number);
 	    n.c -= 2;
 	    h->parent = cvs_master_find_branch(cm, atom_cvs_number(n));
 	    if (!h->parent && !cvs_is_vendor(h->number))
@@ -12,6 +12,52 @@
 #include "cvs.h"
 #include "hash.h"
 #include "revdir.h"
+#ifdef THREADS
+#include <pthread.h>
+#endif /* THREADS */
+
+/*
+ * Packed directories are shared through one hash table, which several
+ * threads may be packing into at once.  Lookups walk the chains
+ * without a lock, since entries are only ever pushed on the front;
+ * adding one takes the lock for its stripe of buckets.
+ */
+#define PACK_STRIPES	64
+
+#ifdef THREADS
+static pthread_mutex_t	pack_locks[PACK_STRIPES];
+static pthread_once_t	pack_once = PTHREAD_ONCE_INIT;
+
+static void
+pack_locks_init(void)
+{
+    int i;
+
+    for (i = 0; i < PACK_STRIPES; i++)
+	pthread_mutex_init(&pack_locks[i], NULL);
+}
+#endif /* THREADS */
+
+static void
+pack_lock(const size_t bucket)
+/* lock a hash bucket against other packing threads */
+{
+#ifdef THREADS
+    if (threads > 1) {
+	pthread_once(&pack_once, pack_locks_init);
+	pthread_mutex_lock(&pack_locks[bucket % PACK_STRIPES]);
+    }
+#endif /* THREADS */
+}
+
+static void
+pack_unlock(const size_t bucket)
+{
+#ifdef THREADS
+    if (threads > 1)
+	pthread_mutex_unlock(&pack_locks[bucket % PACK_STRIPES]);
+#endif /* THREADS */
+}
 
 static bool
 dir_is_ancestor(const master_dir *child, const master_dir *ancestor)
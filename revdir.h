@@ -16,21 +16,46 @@ revdir_pack_files(const cvs_commit **files, const size_t nfiles, revdir *revdir)
 serial_t
 revdir_nfiles(const revdir *revdir);
 
-/* Create a revdir a file at a time */
-void
+/*
+ * Create a revdir a file at a time.  A packer holds one pack in
+ * progress; threads packing at the same time each need their own.
+ */
+typedef struct _revdir_packer revdir_packer;
+
+revdir_packer *
 revdir_pack_alloc(const size_t max_size);
 
 void
-revdir_pack_init(void);
+revdir_pack_init(revdir_packer *packer);
+
+void
+revdir_pack_add(revdir_packer *packer, const cvs_commit *file, const master_dir *dir);
+
+void
+revdir_pack_end(revdir_packer *packer, revdir *revdir);
 
 void
-revdir_pack_add(const cvs_commit *file, const master_dir *dir);
+revdir_pack_free(revdir_packer *packer);
+
+/*
+ * Create a run of revdirs over a fixed set of file slots, each from
+ * the one before, repacking only the directories whose slots changed.
+ * dirs gives each slot's directory, in the order files are packed in.
+ */
+typedef struct _revdir_chain revdir_chain;
+
+revdir_chain *
+revdir_chain_alloc(const master_dir **dirs, const size_t nslots);
+
+/* put a file in a slot, or empty it with NULL */
+void
+revdir_chain_set(revdir_chain *chain, const size_t slot, const cvs_commit *file);
 
 void
-revdir_pack_end(revdir *revdir);
+revdir_chain_pack(revdir_chain *chain, revdir *revdir);
 
 void
-revdir_pack_free(void);
+revdir_chain_free(revdir_chain *chain);
 
 /* allocate an iterator to use with a revdir */
 revdir_iter *
@@ -52,9 +77,6 @@ revdir_iter_next_dir(revdir_iter *it);
 bool
 revdir_iter_same_dir(const revdir_iter *it1, const revdir_iter *it2);
 
-void
-revdir_free_bufs(void);
-
 void
 revdir_free(void);
 
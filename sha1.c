@@ -0,0 +1,105 @@
+/*
+ * SHA-1, as in FIPS 180-4.  Only used to give snapshots the same
+ * identity git does, so blob deduplication matches what fast-import
+ * would conclude; nothing here is relied on for security.
+ *
+ *  SPDX-License-Identifier: GPL-2.0+
+ */
+
+#include <string.h>
+
+#include "sha1.h"
+
+#define ROTL(x, n)	(((x) << (n)) | ((x) >> (32 - (n))))
+
+static void
+sha1_block(uint32_t state[5], const uint8_t *p)
+/* fold one 64-byte block into the state */
+{
+    uint32_t w[80], a, b, c, d, e, f, k, t;
+    int i;
+
+    for (i = 0; i < 16; i++)
+	w[i] = (uint32_t)p[4*i] << 24 | (uint32_t)p[4*i+1] << 16
+	    | (uint32_t)p[4*i+2] << 8 | p[4*i+3];
+    for (; i < 80; i++)
+	w[i] = ROTL(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
+
+    a = state[0]; b = state[1]; c = state[2]; d = state[3]; e = state[4];
+    for (i = 0; i < 80; i++) {
+	if (i < 20) {
+	    f = (b & c) | (~b & d);
+	    k = 0x5a827999;
+	} else if (i < 40) {
+	    f = b ^ c ^ d;
+	    k = 0x6ed9eba1;
+	} else if (i < 60) {
+	    f = (b & c) | (b & d) | (c & d);
+	    k = 0x8f1bbcdc;
+	} else {
+	    f = b ^ c ^ d;
+	    k = 0xca62c1d6;
+	}
+	t = ROTL(a, 5) + f + e + k + w[i];
+	e = d; d = c; c = ROTL(b, 30); b = a; a = t;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d; state[4] += e;
+}
+
+void
+sha1_init(sha1_ctx *ctx)
+{
+    ctx->state[0] = 0x67452301;
+    ctx->state[1] = 0xefcdab89;
+    ctx->state[2] = 0x98badcfe;
+    ctx->state[3] = 0x10325476;
+    ctx->state[4] = 0xc3d2e1f0;
+    ctx->length = 0;
+}
+
+void
+sha1_update(sha1_ctx *ctx, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    size_t used = ctx->length % 64;
+
+    ctx->length += len;
+    if (used > 0) {
+	size_t fill = 64 - used;
+
+	if (len < fill) {
+	    memcpy(ctx->block + used, p, len);
+	    return;
+	}
+	memcpy(ctx->block + used, p, fill);
+	sha1_block(ctx->state, ctx->block);
+	p += fill;
+	len -= fill;
+    }
+    for (; len >= 64; p += 64, len -= 64)
+	sha1_block(ctx->state, p);
+    memcpy(ctx->block, p, len);
+}
+
+void
+sha1_final(sha1_ctx *ctx, uint8_t digest[SHA1_SIZE])
+{
+    uint64_t bits = ctx->length * 8;
+    size_t used = ctx->length % 64;
+    int i;
+
+    ctx->block[used++] = 0x80;
+    if (used > 56) {
+	memset(ctx->block + used, 0, 64 - used);
+	sha1_block(ctx->state, ctx->block);
+	used = 0;
+    }
+    memset(ctx->block + used, 0, 56 - used);
+    for (i = 0; i < 8; i++)
+	ctx->block[56 + i] = bits >> (56 - 8 * i);
+    sha1_block(ctx->state, ctx->block);
+    for (i = 0; i < SHA1_SIZE; i++)
+	digest[i] = ctx->state[i / 4] >> (24 - 8 * (i % 4));
+}
+
+/* end */
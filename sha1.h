@@ -0,0 +1,24 @@
+#ifndef _SHA1_H_
+#define _SHA1_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA1_SIZE	20
+
+typedef struct _sha1_ctx {
+    uint32_t	state[5];
+    uint64_t	length;		/* bytes hashed so far */
+    uint8_t	block[64];
+} sha1_ctx;
+
+void
+sha1_init(sha1_ctx *ctx);
+
+void
+sha1_update(sha1_ctx *ctx, const void *data, size_t len);
+
+void
+sha1_final(sha1_ctx *ctx, uint8_t digest[SHA1_SIZE]);
+
+#endif /* _SHA1_H_ */
@@ -55,7 +55,7 @@ static tag_t *find_tag(const char *name)
     return tag;
 }
 
-void tag_commit(cvs_commit *c, const char *name, cvs_file *cvsfile)
+void tag_commit(cvs_commit *c, const char *name, cvs_file *cvsfile, int serial)
 /* add a CVS commit to the list associated with a named tag */
 {
     tag_t *tag;
@@ -64,6 +64,10 @@ void tag_commit(cvs_commit *c, const char *name, cvs_file *cvsfile)
 	pthread_mutex_lock(&tag_mutex);
 #endif /* THREADS */
     tag = find_tag(name);
+    if (tag->first == NULL || c->master < tag->first) {
+	tag->first = c->master;
+	tag->serial = serial;
+    }
     if (tag->last == cvsfile->gen.master_name) {
 	announce("duplicate tag %s in CVS master %s, ignoring\n",
 		 name, cvsfile->gen.master_name);
@@ -84,6 +88,46 @@ void tag_commit(cvs_commit *c, const char *name, cvs_file *cvsfile)
 #endif /* THREADS */
 }
 
+static int tag_compare(const void *a, const void *b)
+/* latest registration in a path-order walk of the masters first */
+{
+    const tag_t *ta = *(const tag_t **)a, *tb = *(const tag_t **)b;
+
+    if (ta->first != tb->first)
+	return ta->first > tb->first ? -1 : 1;
+    return tb->serial - ta->serial;
+}
+
+void sort_tags(void)
+/* put the tag list in the order a single-threaded analysis would give */
+{
+    tag_t **v, *tag;
+    size_t i = 0;
+
+    if (tag_count < 2)
+	return;
+    v = xmalloc(tag_count * sizeof(tag_t *), __func__);
+    for (tag = all_tags; tag; tag = tag->next)
+	v[i++] = tag;
+    qsort(v, tag_count, sizeof(tag_t *), tag_compare);
+    all_tags = NULL;
+    while (i--) {
+	v[i]->next = all_tags;
+	all_tags = v[i];
+    }
+    free(v);
+}
+
+static int tagged_compare(const void *a, const void *b)
+/* latest master in path order first, as a single thread registers them */
+{
+    const cvs_commit *ca = *(const cvs_commit **)a, *cb = *(const cvs_commit **)b;
+
+    if (ca->master != cb->master)
+	return ca->master > cb->master ? -1 : 1;
+    return 0;
+}
+
 cvs_commit **tagged(tag_t *tag)
 /* return an allocated list of pointers to commits with the specified tag */
 {
@@ -100,6 +144,11 @@ cvs_commit **tagged(tag_t *tag)
 
 	for (c = c->next, p += n; c; c = c->next, p += Ncommits)
 	    memcpy(p, c->v, Ncommits * sizeof(*p));
+#ifdef THREADS
+	/* workers may have registered the masters in any order */
+	if (threads > 1)
+	    qsort(v, tag->count, sizeof(*v), tagged_compare);
+#endif /* THREADS */
     }
     return v;
 }
@@ -0,0 +1,38 @@
+#!/bin/sh
+## Time changeset collation on the t960x repositories
+#
+# usage: collate-bench.sh [cvs-fast-export [repetitions [repo...]]]
+#
+# Converts each repository repeatedly on one thread and reports the
+# mean wall time per conversion alongside the total time -p charged
+# to "Collate common branches".  The t960x repositories are small, so
+# the collation figure is only meaningful summed over many runs; name
+# larger repositories on the command line to see it at scale.  Run it
+# from the tests directory, or with "make bench" from the top.
+
+cfe=${1:-cvs-fast-export}
+reps=${2:-200}
+[ $# -gt 2 ] && shift 2 || set -- t9601.testrepo t9602.testrepo t9603.testrepo t9604.testrepo t9605.testrepo
+
+printf "%-20s %12s %14s\n" "repository" "ms/convert" "collate total"
+for repo in "$@"
+do
+    list=$(find "$repo" -name '*,v' | sort)
+    start=$(date +%s.%N)
+    collate=0
+    i=0
+    while [ "$i" -lt "$reps" ]
+    do
+	t=$(echo "$list" | "$cfe" -t 1 -p 2>&1 >/dev/null \
+	    | tr '\r' '\n' \
+	    | sed -n 's/.*Collate common branches.*(\([0-9.]*\)sec).*/\1/p' \
+	    | tail -1)
+	collate=$(echo "$collate ${t:-0}" | awk '{print $1 + $2}')
+	i=$((i + 1))
+    done
+    end=$(date +%s.%N)
+    echo "$start $end $reps $collate" | awk -v repo="$(basename "$repo")" \
+	'{printf "%-20s %12.3f %13.3fs\n", repo, ($2 - $1) * 1000 / $3, $4}'
+done
+
+#end
@@ -0,0 +1,48 @@
+#!/bin/sh
+## Test that --parse-cache reproduces uncached conversions
+work="/tmp/parsecache-$$"
+
+trap 'rm -fr $work' EXIT HUP INT QUIT TERM
+
+echo "${USER:-root} = foo <foo> -0500" >neutralize.map
+
+convert() {
+    find $work/module -name '*,v' | cvs-fast-export -T -A neutralize.map --reposurgeon "$@" 2>&1
+}
+
+mkdir $work
+cp -r oldhead.testrepo/module $work/module
+master=$work/module/ChangeLog,v
+touch -d @1000000000.100000000 $master
+
+# The first run fills the cache, the second one reads it back
+status=ok
+for pass in cold warm
+do
+    convert --parse-cache $work/cache | cmp -s - oldhead.chk || status="not ok"
+    [ "$(ls $work/cache 2>/dev/null | wc -l)" -eq "$(find $work/module -name '*,v' | wc -l)" ] || status="not ok"
+done
+
+# Edit an author in place without changing the master's size, inode or
+# mtime: only a run served from the cache still sees the old one
+sed -e 's/author jimb;/author jimx;/' oldhead.testrepo/module/ChangeLog,v >$work/edited
+cat $work/edited >$master
+touch -d @1000000000.100000000 $master
+convert --parse-cache $work/cache | cmp -s - oldhead.chk || status="not ok"
+
+# Moving the mtime on by a nanosecond is enough to make that a miss
+touch -d @1000000000.100000001 $master
+convert >$work/fresh
+grep -q "jimx" $work/fresh || status="not ok"
+convert --parse-cache $work/cache | cmp -s - $work/fresh || status="not ok"
+
+# An edited master must be parsed again, not served from the cache
+sed -e 's/^@efd85ec997fe32634876c4d0172436fe/@edited log message/' oldhead.testrepo/module/ChangeLog,v >$master
+convert >$work/fresh
+convert --parse-cache $work/cache | cmp -s - $work/fresh || status="not ok"
+grep -q "edited log message" $work/fresh || status="not ok"
+
+echo "$status - $0"
+[ "$status" = ok ]
+
+#end
@@ -35,42 +35,74 @@ typedef struct _pack_frame {
     unsigned short      sdirs;
 } pack_frame;
 
-/* variables used by streaming pack interface */
-static serial_t         sfiles = 0;
-static serial_t         nfiles = 0;
-static const cvs_commit **files = NULL;
-static pack_frame       *frame;
-static pack_frame       frames[MAX_DIR_DEPTH];
+/* state of one streaming pack; each packing thread has its own */
+struct _revdir_packer {
+    serial_t		sfiles;
+    serial_t		nfiles;
+    const cvs_commit	**files;
+    pack_frame		*frame;
+    pack_frame		frames[MAX_DIR_DEPTH];
+};
+
+static rev_pack_hash *
+rev_pack_find(rev_pack_hash *h, const hash_t hash,
+	      const rev_pack * const *dirs, const serial_t ndirs,
+	      const cvs_commit * const *files, const serial_t nfiles)
+/* look along a hash chain for a directory */
+{
+    for (; h; h = h->next) {
+	if (h->dir.hash == hash &&
+	    h->dir.nfiles == nfiles && h->dir.ndirs == ndirs &&
+	    !memcmp(dirs, h->dir.dirs, ndirs * sizeof(rev_pack *)) &&
+	    !memcmp(files, h->dir.files, nfiles * sizeof(cvs_commit *)))
+	    return h;
+    }
+    return NULL;
+}
 
 static const rev_pack *
-rev_pack_dir(void)
+rev_pack_intern(const hash_t hash,
+		const rev_pack * const *dirs, const serial_t ndirs,
+		const cvs_commit * const *files, const serial_t nfiles)
+/* pack a directory, or find the one packed before with the same contents */
 {
-    rev_pack_hash **bucket = &buckets[frame->hash % REV_DIR_HASH];
+    const size_t slot = hash % REV_DIR_HASH;
+    rev_pack_hash **bucket = &buckets[slot];
     rev_pack_hash *h;
 
     /* avoid packing a file list if we've done it before */ 
-    for (h = *bucket; h; h = h->next) {
-	if (h->dir.hash == frame->hash &&
-	    h->dir.nfiles == nfiles && h->dir.ndirs == frame->ndirs &&
-	    !memcmp(frame->dirs, h->dir.dirs, frame->ndirs * sizeof(rev_pack *)) &&
-	    !memcmp(files, h->dir.files, nfiles * sizeof(cvs_commit *)))
-	{
-	    return &h->dir;
-	}
+    h = rev_pack_find(__atomic_load_n(bucket, __ATOMIC_ACQUIRE),
+		      hash, dirs, ndirs, files, nfiles);
+    if (h)
+	return &h->dir;
+    pack_lock(slot);
+    /* another thread may have packed the same thing since we looked */
+    h = rev_pack_find(*bucket, hash, dirs, ndirs, files, nfiles);
+    if (!h) {
+	h = xmalloc(sizeof(rev_pack_hash), __func__);
+	h->next = *bucket;
+	h->dir.hash = hash;
+	h->dir.ndirs = ndirs;
+	h->dir.dirs = xmalloc(ndirs * sizeof(rev_pack *), __func__);
+	memcpy(h->dir.dirs, dirs, ndirs * sizeof(rev_pack *));
+	h->dir.nfiles = nfiles;
+	h->dir.files = xmalloc(nfiles * sizeof(cvs_commit *), __func__);
+	memcpy(h->dir.files, files, nfiles * sizeof(cvs_commit *));
+	__atomic_store_n(bucket, h, __ATOMIC_RELEASE);
     }
-    h = xmalloc(sizeof(rev_pack_hash), __func__);
-    h->next = *bucket;
-    *bucket = h;
-    h->dir.hash = frame->hash;
-    h->dir.ndirs = frame->ndirs;
-    h->dir.dirs = xmalloc(frame->ndirs * sizeof(rev_pack *), __func__);
-    memcpy(h->dir.dirs, frame->dirs, frame->ndirs * sizeof(rev_pack *));
-    h->dir.nfiles = nfiles;
-    h->dir.files = xmalloc(nfiles * sizeof(cvs_commit *), __func__);
-    memcpy(h->dir.files, files, nfiles * sizeof(cvs_commit *));
+    pack_unlock(slot);
     return &h->dir;
 }
 
+static const rev_pack *
+rev_pack_dir(revdir_packer *p)
+{
+    const pack_frame *frame = p->frame;
+
+    return rev_pack_intern(frame->hash, frame->dirs, frame->ndirs,
+			   p->files, p->nfiles);
+}
+
 /* Post order tree traversal iterator. */
 typedef struct _dir_pos {
     const rev_pack *parent;
@@ -197,30 +229,28 @@ first_subdir (const master_dir *child, const master_dir *ancestor)
     return child;
 }
 
-void
+revdir_packer *
 revdir_pack_alloc(const size_t max_size)
 {
-    if (!files) {
-	files = xmalloc(max_size * sizeof(cvs_commit *), __func__);
-	sfiles = max_size;
-    } else if (sfiles < max_size) {
-	files = xrealloc(files, max_size * sizeof(cvs_commit *), __func__);
-	sfiles = max_size;
-    }
+    revdir_packer *p = xcalloc(1, sizeof(revdir_packer), __func__);
+
+    p->files = xmalloc(max_size * sizeof(cvs_commit *), __func__);
+    p->sfiles = max_size;
+    return p;
 }
 
 void
-revdir_pack_init(void)
+revdir_pack_init(revdir_packer *p)
 {
-    frame = frames;
-    nfiles = 0;
-    frames[0].dir = root_dir;
-    frames[0].ndirs = 0;
-    frames[0].hash = hash_init();
+    p->frame = p->frames;
+    p->nfiles = 0;
+    p->frames[0].dir = root_dir;
+    p->frames[0].ndirs = 0;
+    p->frames[0].hash = hash_init();
 }
 
 static void
-push_rev_pack(const rev_pack * const r)
+push_rev_pack(pack_frame *frame, const rev_pack * const r)
 /* Store a revpack in the recursive gathering area */
 {
     unsigned short *s = &frame->sdirs;
@@ -235,14 +265,16 @@ push_rev_pack(const rev_pack * const r)
 }
 
 void
-revdir_pack_add(const cvs_commit *file, const master_dir *dir)
+revdir_pack_add(revdir_packer *p, const cvs_commit *file, const master_dir *dir)
 {
+    pack_frame *frame = p->frame;
+
     while (1) {
 	if (frame->dir == dir) {
 	    /* If you are using TREEPACK then this is the hottest inner
 	     * loop in the application. Avoid dereferencing file
              */
-	    files[nfiles++] = file;
+	    p->files[p->nfiles++] = file;
 	    /* Proper FNV1a is a byte at a time, but this is effective
 	     * with the amount of data we're typically mixing into the hash
              * and very lightweight
@@ -251,48 +283,51 @@ revdir_pack_add(const cvs_commit *file, const master_dir *dir)
 	    return;
 	}
 	if (dir_is_ancestor(dir, frame->dir)) {
-	    if (frame - frames == MAX_DIR_DEPTH)
+	    if (frame - p->frames == MAX_DIR_DEPTH)
 		fatal_error("Directories nested too deep, increase MAX_DIR_DEPTH\n");
 	    
 	    const master_dir *parent = frame++->dir;
 	    frame->dir = first_subdir(dir, parent);
 	    frame->ndirs = 0;
 	    frame->hash = hash_init();
+	    p->frame = frame;
 	    continue;
 	}
 	
-	const rev_pack * const r = rev_pack_dir();
-	nfiles = 0;
-	frame--;
+	const rev_pack * const r = rev_pack_dir(p);
+	p->nfiles = 0;
+	p->frame = --frame;
 	frame->hash = HASH_COMBINE(frame->hash, r->hash);
-	push_rev_pack(r);
+	push_rev_pack(frame, r);
     }
 }
 
 void
-revdir_pack_end(revdir *revdir)
+revdir_pack_end(revdir_packer *p, revdir *revdir)
 {
     const rev_pack * r = NULL;
     while (1) {
-	r = rev_pack_dir();
-	if (frame == frames)
+	r = rev_pack_dir(p);
+	if (p->frame == p->frames)
 	    break;
 	
-	nfiles = 0;
-	frame--;
-	frame->hash = HASH_COMBINE(frame->hash, r->hash);
-	push_rev_pack(r);
+	p->nfiles = 0;
+	p->frame--;
+	p->frame->hash = HASH_COMBINE(p->frame->hash, r->hash);
+	push_rev_pack(p->frame, r);
     }
     revdir->revpack = r;
 }
 
 void
-revdir_pack_free(void)
+revdir_pack_free(revdir_packer *p)
 {
-    free(files);
-    files = NULL;
-    nfiles = 0;
-    sfiles = 0;
+    size_t i;
+
+    for (i = 0; i < MAX_DIR_DEPTH; i++)
+	free(p->frames[i].dirs);
+    free(p->files);
+    free(p);
 }
 
 static serial_t
@@ -336,13 +371,218 @@ revdir_pack_files(const cvs_commit **files, const size_t nfiles, revdir *revdir)
      * masters at the input stage causes them to come out in the right
      * order here, without multiple additional sorts.
      */
-    revdir_pack_alloc(nfiles);
-    revdir_pack_init();
+    revdir_packer *p = revdir_pack_alloc(nfiles);
+    revdir_pack_init(p);
     for (i = 0; i < nfiles; i++)
-	revdir_pack_add(files[i], files[i]->dir);
+	revdir_pack_add(p, files[i], files[i]->dir);
 	
-    revdir_pack_end(revdir);
-    revdir_pack_free();
+    revdir_pack_end(p, revdir);
+    revdir_pack_free(p);
+}
+
+/*
+ * A chain builds the revdirs of a run of commits over the same slots,
+ * each from the one before.  The slots are laid out once into the
+ * directory nodes a streaming pack of all of them would push, and
+ * each node keeps the rev_pack it got last time.  Changing a slot
+ * dirties its node and the nodes above it, and only dirty nodes are
+ * packed again; every other directory is shared by pointer.  A node
+ * lists its slots and child nodes in slot order, so packing it mixes
+ * the hash just as the streaming pack does and finds the same
+ * rev_pack.  This relies on every directory's slots being contiguous,
+ * which the path order the masters are sorted in guarantees.
+ */
+typedef struct _chain_node {
+    const rev_pack	*pack;		/* last packed, NULL if empty */
+    int			parent;		/* -1 for the root */
+    int			first, last;	/* its run of items */
+    bool		dirty;
+} chain_node;
+
+struct _revdir_chain {
+    size_t		nslots;
+    const cvs_commit	**slots;	/* current file in each slot */
+    int			*slot_node;
+    chain_node		*nodes;
+    int			nnodes;
+    int			*items;		/* slot, or ~node for a subdir */
+    int			*dirty;		/* nodes to pack, unordered */
+    int			ndirty;
+    const cvs_commit	**files;	/* gathering area for one node */
+    const rev_pack	**dirs;
+};
+
+static void
+chain_dirty(revdir_chain *chain, int n)
+/* mark a node and the nodes above it for packing */
+{
+    for (; n >= 0 && !chain->nodes[n].dirty; n = chain->nodes[n].parent) {
+	chain->nodes[n].dirty = true;
+	chain->dirty[chain->ndirty++] = n;
+    }
+}
+
+revdir_chain *
+revdir_chain_alloc(const master_dir **dirs, const size_t nslots)
+{
+    revdir_chain *chain = xcalloc(1, sizeof(revdir_chain), __func__);
+    size_t snodes = nslots + 1, sitems = 2 * nslots + MAX_DIR_DEPTH;
+    int *stack = xmalloc(MAX_DIR_DEPTH * sizeof(int), __func__);
+    int *owner = xmalloc(sitems * sizeof(int), __func__);
+    int *order = xmalloc(sitems * sizeof(int), __func__);
+    const master_dir **nodedir;
+    int depth = 0, nitems = 0, widest = 0, n;
+    size_t i;
+
+    chain->nslots = nslots;
+    chain->slots = xcalloc(snodes, sizeof(cvs_commit *), __func__);
+    chain->slot_node = xmalloc(snodes * sizeof(int), __func__);
+    chain->nodes = xmalloc(snodes * sizeof(chain_node), __func__);
+    nodedir = xmalloc(snodes * sizeof(master_dir *), __func__);
+
+    /*
+     * Lay out the nodes by walking the slots the way revdir_pack_add()
+     * walks files, noting each item against the node it goes in.
+     */
+    chain->nnodes = 1;
+    chain->nodes[0].parent = -1;
+    nodedir[0] = root_dir;
+    stack[0] = 0;
+    for (i = 0; i < nslots; i++) {
+	const master_dir *dir = dirs[i];
+
+	while (nodedir[stack[depth]] != dir) {
+	    /* room for this item and a node's for each level below */
+	    if ((size_t)nitems + MAX_DIR_DEPTH >= sitems) {
+		sitems *= 2;
+		owner = xrealloc(owner, sitems * sizeof(int), __func__);
+		order = xrealloc(order, sitems * sizeof(int), __func__);
+	    }
+	    if (!dir_is_ancestor(dir, nodedir[stack[depth]])) {
+		depth--;
+		continue;
+	    }
+	    if (depth + 1 == MAX_DIR_DEPTH)
+		fatal_error("Directories nested too deep, increase MAX_DIR_DEPTH\n");
+	    if ((size_t)chain->nnodes == snodes) {
+		snodes *= 2;
+		chain->nodes = xrealloc(chain->nodes,
+					snodes * sizeof(chain_node), __func__);
+		nodedir = xrealloc(nodedir, snodes * sizeof(master_dir *),
+				   __func__);
+	    }
+	    n = chain->nnodes++;
+	    chain->nodes[n].parent = stack[depth];
+	    nodedir[n] = first_subdir(dir, nodedir[stack[depth]]);
+	    owner[nitems] = stack[depth];
+	    order[nitems++] = ~n;
+	    stack[++depth] = n;
+	}
+	chain->slot_node[i] = stack[depth];
+	owner[nitems] = stack[depth];
+	order[nitems++] = (int)i;
+    }
+    free(nodedir);
+    free(stack);
+
+    /* gather each node's items into a run, keeping their order */
+    for (n = 0; n < chain->nnodes; n++)
+	chain->nodes[n].first = chain->nodes[n].last = 0;
+    for (i = 0; i < (size_t)nitems; i++)
+	chain->nodes[owner[i]].last++;
+    for (n = 0, i = 0; n < chain->nnodes; n++) {
+	int count = chain->nodes[n].last;
+	if (count > widest)
+	    widest = count;
+	chain->nodes[n].first = chain->nodes[n].last = (int)i;
+	i += count;
+    }
+    chain->items = xmalloc((nitems ? nitems : 1) * sizeof(int), __func__);
+    for (i = 0; i < (size_t)nitems; i++)
+	chain->items[chain->nodes[owner[i]].last++] = order[i];
+    free(owner);
+    free(order);
+
+    chain->files = xmalloc((widest ? widest : 1) * sizeof(cvs_commit *), __func__);
+    chain->dirs = xmalloc((widest ? widest : 1) * sizeof(rev_pack *), __func__);
+    chain->dirty = xmalloc(chain->nnodes * sizeof(int), __func__);
+
+    /* everything starts out empty and in need of packing */
+    chain->ndirty = 0;
+    for (n = 0; n < chain->nnodes; n++) {
+	chain->nodes[n].pack = NULL;
+	chain->nodes[n].dirty = false;
+    }
+    for (n = chain->nnodes - 1; n >= 0; n--)
+	chain_dirty(chain, n);
+    return chain;
+}
+
+void
+revdir_chain_set(revdir_chain *chain, const size_t slot, const cvs_commit *file)
+{
+    if (chain->slots[slot] == file)
+	return;
+    chain->slots[slot] = file;
+    chain_dirty(chain, chain->slot_node[slot]);
+}
+
+static int
+chain_node_compare(const void *a, const void *b)
+/* children are laid out after their parents, so pack backwards */
+{
+    return *(const int *)b - *(const int *)a;
+}
+
+void
+revdir_chain_pack(revdir_chain *chain, revdir *revdir)
+{
+    int i, k;
+
+    qsort(chain->dirty, chain->ndirty, sizeof(int), chain_node_compare);
+    for (k = 0; k < chain->ndirty; k++) {
+	chain_node *node = &chain->nodes[chain->dirty[k]];
+	serial_t nfiles = 0, ndirs = 0;
+	hash_t hash = hash_init();
+
+	for (i = node->first; i < node->last; i++) {
+	    const int item = chain->items[i];
+
+	    if (item >= 0) {
+		const cvs_commit *file = chain->slots[item];
+		if (!file)
+		    continue;
+		chain->files[nfiles++] = file;
+		hash = (hash ^ (uintptr_t)file) * 16777619U;
+	    } else if (chain->nodes[~item].pack) {
+		const rev_pack *r = chain->nodes[~item].pack;
+		chain->dirs[ndirs++] = r;
+		hash = HASH_COMBINE(hash, r->hash);
+	    }
+	}
+	/* only the root is packed when empty, as in a streaming pack */
+	if (nfiles || ndirs || node->parent < 0)
+	    node->pack = rev_pack_intern(hash, chain->dirs, ndirs,
+					 chain->files, nfiles);
+	else
+	    node->pack = NULL;
+	node->dirty = false;
+    }
+    chain->ndirty = 0;
+    revdir->revpack = chain->nodes[0].pack;
+}
+
+void
+revdir_chain_free(revdir_chain *chain)
+{
+    free(chain->slots);
+    free(chain->slot_node);
+    free(chain->nodes);
+    free(chain->items);
+    free(chain->dirty);
+    free(chain->files);
+    free(chain->dirs);
+    free(chain);
 }
 
 void
@@ -362,13 +602,3 @@ revdir_free(void)
     }
 }
 
-void
-revdir_free_bufs(void)
-{
-    size_t i;
-    for (i = 0; i < MAX_DIR_DEPTH; i++) {
-	free(frames[i].dirs);
-	frames[i].dir = NULL;
-	frames[i].sdirs = 0;
-    }
-}